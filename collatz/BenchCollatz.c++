@@ -0,0 +1,331 @@
+// ---------------------------------
+// projects/collatz/BenchCollatz.c++
+// Copyright (C) 2016
+// Glenn P. Downing
+// ---------------------------------
+
+// --------
+// includes
+// --------
+
+#include <algorithm>      // max, min, sort
+#include <cerrno>         // errno, EINTR
+#include <chrono>         // duration, steady_clock
+#include <cstdint>        // uint16_t
+#include <cstdio>         // snprintf
+#include <cstdlib>        // strtoul
+#include <fcntl.h>        // open, O_WRONLY
+#include <functional>     // function
+#include <iostream>       // cerr, cout, endl
+#include <memory>         // unique_ptr
+#include <random>         // mt19937_64, uniform_int_distribution
+#include <sstream>        // istringstream, ostringstream
+#include <stdexcept>      // runtime_error
+#include <string>         // string
+#include <thread>         // thread
+#include <sys/resource.h> // getrusage, rusage
+#include <sys/wait.h>     // waitpid, WEXITSTATUS, WIFEXITED
+#include <unistd.h>       // close, fork, lseek, mkstemp, unlink, write, _exit
+#include <utility>        // make_pair, pair
+#include <vector>         // vector
+
+#include "Collatz.h"
+
+namespace {
+
+using namespace std;
+
+typedef pair<long long, long long> range;
+typedef chrono::steady_clock       clock_type;
+
+// -------
+// seconds
+// -------
+
+double seconds (clock_type::time_point b, clock_type::time_point e) {
+    return chrono::duration<double>(e - b).count();}
+
+// -------
+// peak_kb
+// -------
+
+// the peak resident set of the process so far, in KB on Linux;
+// each mode runs in a process of its own, so this is the peak of that mode
+long peak_kb () {
+    rusage u;
+    getrusage(RUSAGE_SELF, &u);
+    return u.ru_maxrss;}
+
+// ---------
+// workloads
+// ---------
+
+const long long bench_bound = 1000000;
+
+/**
+ * short ranges anywhere below bench_bound
+ */
+vector<range> narrow (mt19937_64& g, size_t n) {
+    uniform_int_distribution<long long> i(1, bench_bound - 1);
+    uniform_int_distribution<long long> d(0, 999);
+    vector<range> v;
+    for (size_t k = 0; k != n; ++k) {
+        const long long b = i(g);
+        v.push_back(make_pair(b, min(b + d(g), bench_bound - 1)));}
+    return v;}
+
+/**
+ * ranges with both ends anywhere below bench_bound, in either order
+ */
+vector<range> wide (mt19937_64& g, size_t n) {
+    uniform_int_distribution<long long> i(1, bench_bound - 1);
+    vector<range> v;
+    for (size_t k = 0; k != n; ++k)
+        v.push_back(make_pair(i(g), i(g)));
+    return v;}
+
+/**
+ * a few dozen wide ranges, each asked for over and over
+ */
+vector<range> overlap (mt19937_64& g, size_t n) {
+    const vector<range> p = wide(g, 32);
+    uniform_int_distribution<size_t> k(0, p.size() - 1);
+    vector<range> v;
+    for (size_t q = 0; q != n; ++q)
+        v.push_back(p[k(g)]);
+    return v;}
+
+/**
+ * a mix of what each mode likes least:
+ * short ranges far past any cache or index, ranges around seeds with the longest cycles,
+ * and ranges that only touch the partial blocks at either end of an index block
+ */
+vector<range> adversarial (mt19937_64& g, size_t n) {
+    const long long seeds[] = {837799, 8400511, 63728127, 670617279, 9780657630LL, 75128138247LL};
+    uniform_int_distribution<long long> f(1LL << 32, 1LL << 40);
+    uniform_int_distribution<long long> d(0, 63);
+    uniform_int_distribution<long long> b(0, (bench_bound / collatz_index::default_block) - 3);
+    vector<range> v;
+    for (size_t k = 0; k != n; ++k) {
+        switch (k % 3) {
+            case 0: {
+                const long long i = f(g);
+                v.push_back(make_pair(i, i + d(g)));
+                break;}
+            case 1: {
+                const long long s = seeds[(k / 3) % (sizeof(seeds) / sizeof(seeds[0]))];
+                v.push_back(make_pair(s - d(g), s + d(g)));
+                break;}
+            default: {
+                const long long i = (b(g) * collatz_index::default_block) + collatz_index::default_block - 1;
+                v.push_back(make_pair(i, i + collatz_index::default_block + 1));}}}
+    return v;}
+
+// ------
+// result
+// ------
+
+struct result {
+    double          setup   = 0;  // seconds before the first query
+    double          total   = 0;  // seconds for every query
+    vector<double>  latency;      // seconds per query, if the mode measures them
+    long long       hits    = -1; // -1 if the mode doesn't count them
+    long long       misses  = -1;};
+
+double percentile (const vector<double>& s, double p) {
+    return s[min(s.size() - 1, size_t(p * s.size()))];}
+
+void report (const string& w, const string& m, size_t n, result& r) {
+    char b[256];
+    string l[4] = {"-", "-", "-", "-"};
+    if (!r.latency.empty()) {
+        sort(r.latency.begin(), r.latency.end());
+        const double ps[] = {0.50, 0.90, 0.99, 1.0};
+        for (int k = 0; k != 4; ++k) {
+            snprintf(b, sizeof(b), "%.1f", 1e6 * percentile(r.latency, ps[k]));
+            l[k] = b;}}
+    string h = "-";
+    if ((r.hits >= 0) && ((r.hits + r.misses) != 0)) {
+        snprintf(b, sizeof(b), "%.4f", double(r.hits) / (r.hits + r.misses));
+        h = b;}
+    snprintf(b, sizeof(b), "%-12s %-6s %8zu %10.1f %12.0f %10s %10s %10s %10s %8s %10ld",
+        w.c_str(), m.c_str(), n, 1e3 * r.setup, n / r.total,
+        l[0].c_str(), l[1].c_str(), l[2].c_str(), l[3].c_str(), h.c_str(), peak_kb());
+    cout << b << endl;}
+
+// -----
+// modes
+// -----
+
+// collatz_eval one query at a time, through a cache or an index
+result eval (const vector<range>& v, bool indexed) {
+    result                       r;
+    const clock_type::time_point b = clock_type::now();
+    collatz_cache                c;
+    unique_ptr<collatz_index>    x;
+    if (indexed)
+        x.reset(new collatz_index(c, bench_bound));
+    r.setup = seconds(b, clock_type::now());
+    const size_t h = c.hits();
+    const size_t m = c.misses();
+    for (const range& q : v) {
+        const clock_type::time_point t = clock_type::now();
+        x ? collatz_eval(*x, q.first, q.second) : collatz_eval(c, q.first, q.second);
+        r.latency.push_back(seconds(t, clock_type::now()));}
+    for (double d : r.latency)
+        r.total += d;
+    r.hits   = c.hits()   - h;
+    r.misses = c.misses() - m;
+    return r;}
+
+string text (const vector<range>& v) {
+    ostringstream o;
+    for (const range& q : v)
+        o << q.first << " " << q.second << "\n";
+    return o.str();}
+
+// collatz_solve through an istream and an ostream
+result solve (const vector<range>& v, collatz_options o) {
+    result r;
+    istringstream i(text(v));
+    ostringstream w;
+    const clock_type::time_point b = clock_type::now();
+    collatz_cache c;
+    o.cache = &c;
+    collatz_solve<long long>(i, w, o);
+    r.total  = seconds(b, clock_type::now());
+    r.hits   = c.hits();
+    r.misses = c.misses();
+    return r;}
+
+// collatz_solve through a collatz_reader of a temporary file and a collatz_writer of /dev/null
+result fast (const vector<range>& v, collatz_options o) {
+    result       r;
+    const string s = text(v);
+    char         p[] = "/tmp/BenchCollatzXXXXXX";
+    const int    i = mkstemp(p);
+    if (i == -1)
+        throw runtime_error("BenchCollatz: can't create a temporary file");
+    unlink(p);
+    if (write(i, s.data(), s.size()) != ssize_t(s.size())) {
+        close(i);
+        throw runtime_error("BenchCollatz: can't write the temporary file");}
+    lseek(i, 0, SEEK_SET);
+    const int w = open("/dev/null", O_WRONLY);
+    const clock_type::time_point b = clock_type::now();
+    collatz_cache c;
+    o.cache = &c;
+    collatz_solve<long long>(i, w, o);
+    r.total  = seconds(b, clock_type::now());
+    r.hits   = c.hits();
+    r.misses = c.misses();
+    close(w);
+    close(i);
+    return r;}
+
+// the block maxima of [1, bench_bound), as a collatz_table
+vector<uint16_t> maxima () {
+    collatz_cache       c;
+    const collatz_index x(c, bench_bound);
+    return vector<uint16_t>(x.maxima(), x.maxima() + x.blocks());}
+
+// fast through the index of a store in a temporary file, built to bench_bound in the setup
+result stored (const vector<range>& v, collatz_options o) {
+    char p[] = "/tmp/BenchCollatzStoreXXXXXX";
+    const int f = mkstemp(p);
+    if (f == -1)
+        throw runtime_error("BenchCollatz: can't create a temporary file");
+    close(f);
+    unlink(p);
+    const clock_type::time_point b = clock_type::now();
+    collatz_store s(p);
+    unlink(p);
+    collatz_cache c;
+    s.extend(c, bench_bound);
+    const double u = seconds(b, clock_type::now());
+    o.mode  = collatz_indexed;
+    o.store = &s;
+    result r = fast(v, o);
+    r.setup = u;
+    return r;}
+
+// runs mode m of workload w in a child process, which prints its line,
+// so that the peak RSS of one mode doesn't carry over into the next
+void isolated (const string& w, const string& m, size_t n, const function<result ()>& f) {
+    cout.flush();
+    const pid_t p = fork();
+    if (p == -1)
+        throw runtime_error("BenchCollatz: fork failed");
+    if (p == 0) {
+        int e = 0;
+        try {
+            result r = f();
+            report(w, m, n, r);}
+        catch (const runtime_error& x) {
+            cerr << x.what() << endl;
+            e = 1;}
+        cout.flush();
+        _exit(e);}
+    int s;
+    while ((waitpid(p, &s, 0) == -1) && (errno == EINTR))
+        continue;
+    if (!WIFEXITED(s) || (WEXITSTATUS(s) != 0))
+        throw runtime_error("BenchCollatz: mode " + m + " of " + w + " failed");}
+
+} // namespace
+
+// ----
+// main
+// ----
+
+/**
+ * runs every mode over every workload and prints one line for each to cout
+ * latencies are in microseconds, and peak RSS in KB
+ * each mode runs in a child process, so its peak RSS is its own, and its hit rate is of its own cache
+ * usage: BenchCollatz [queries [seed]]
+ */
+int main (int argc, char* argv[]) {
+    using namespace std;
+    if (argc > 3) {
+        cerr << "usage: BenchCollatz [queries [seed]]" << endl;
+        return 1;}
+    const size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 2000;
+    const size_t s = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 1;
+    const pair<string, function<vector<range> (mt19937_64&, size_t)>> workloads[] = {
+        make_pair("narrow",      narrow),
+        make_pair("wide",        wide),
+        make_pair("overlap",     overlap),
+        make_pair("adversarial", adversarial)};
+    collatz_options o;
+    o.bound = bench_bound;
+    collatz_options x = o;
+    x.mode = collatz_indexed;
+    // the pool, with at least two threads, even on one core
+    collatz_options t = o;
+    t.threads = max<size_t>(2, thread::hardware_concurrency());
+    // x's index, from block maxima linked in, as GenCollatz's table would be
+    const vector<uint16_t> m = maxima();
+    collatz_options        y = x;
+    y.table = m.data();
+    cout << "workload     mode    queries   setup_ms          qps     p50_us     p90_us     p99_us     max_us hit_rate     rss_kb" << endl;
+    try {
+        for (const auto& w : workloads) {
+            mt19937_64          g(s);
+            const vector<range> v = w.second(g, n);
+            isolated(w.first, "scan",   n, [&] () {return eval(v, false);});
+            isolated(w.first, "index",  n, [&] () {return eval(v, true);});
+            isolated(w.first, "solve",  n, [&] () {return solve(v, o);});
+            isolated(w.first, "fast",   n, [&] () {return fast(v, o);});
+            isolated(w.first, "fastx",  n, [&] () {return fast(v, x);});
+            isolated(w.first, "thread", n, [&] () {return fast(v, t);});
+            isolated(w.first, "store",  n, [&] () {return stored(v, o);});
+            isolated(w.first, "table",  n, [&] () {return fast(v, y);});}}
+    catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;}
+    return 0;}
+
+/*
+% g++ -pedantic -std=c++11 -Wall -O2 -DNDEBUG Collatz.c++ BenchCollatz.c++ -o BenchCollatz -pthread
+% ./BenchCollatz 2000 > BenchCollatz.tmp
+*/
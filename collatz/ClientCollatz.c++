@@ -0,0 +1,77 @@
+// ----------------------------------
+// projects/collatz/ClientCollatz.c++
+// Copyright (C) 2016
+// Glenn P. Downing
+// ----------------------------------
+
+// --------
+// includes
+// --------
+
+#include <cerrno>    // errno, EINTR
+#include <iostream>  // cerr, endl
+#include <stdexcept> // runtime_error
+#include <thread>    // thread
+
+#include <sys/socket.h> // shutdown, SHUT_WR
+#include <unistd.h>     // close, read, write
+
+#include "Collatz.h"
+
+namespace {
+
+// copies r to w until the end of r; false if either fails
+bool pump (int r, int w) {
+    char b[1 << 16];
+    while (true) {
+        ssize_t n = read(r, b, sizeof(b));
+        if ((n < 0) && (errno == EINTR))
+            continue;
+        if (n <= 0)
+            return n == 0;
+        for (const char* p = b; n != 0;) {
+            const ssize_t k = write(w, p, n);
+            if ((k < 0) && (errno == EINTR))
+                continue;
+            if (k < 0)
+                return false;
+            p += k;
+            n -= k;}}}
+
+} // namespace
+
+// ----
+// main
+// ----
+
+/**
+ * sends cin to the RunCollatz --serve listening on path, and writes its answers to cout
+ * cin is sent while the answers come back, so neither side waits on the other
+ * usage: ClientCollatz path
+ */
+int main (int argc, char* argv[]) {
+    using namespace std;
+    if (argc != 2) {
+        cerr << "usage: ClientCollatz path" << endl;
+        return 1;}
+    try {
+        const int s = collatz_connect(argv[1]);
+        bool      b = true;
+        thread    t([&] () {
+            b = pump(0, s);
+            shutdown(s, SHUT_WR);});
+        const bool c = pump(s, 1);
+        t.join();
+        close(s);
+        return (b && c) ? 0 : 1;}
+    catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;}}
+
+/*
+% g++ -pedantic -std=c++11 -Wall Collatz.c++ ClientCollatz.c++ -o ClientCollatz -pthread
+% ./RunCollatz --serve RunCollatz.sock &
+% ./ClientCollatz RunCollatz.sock < RunCollatz.in > RunCollatz.tmp
+% diff RunCollatz.tmp RunCollatz.out
+% kill %1
+*/
@@ -8,45 +8,1422 @@
 // includes
 // --------
 
-#include <cassert>  // assert
-#include <iostream> // endl, istream, ostream
+#include <algorithm>          // copy, equal, find_if, max, max_element, min, swap
+#include <atomic>             // atomic, memory_order_relaxed
+#include <cassert>            // assert
+#include <cerrno>             // errno, ECONNABORTED, EINTR
+#include <chrono>             // duration_cast, nanoseconds, seconds, steady_clock
+#include <condition_variable> // condition_variable
+#include <cstdint>            // uint16_t, uint64_t
+#include <cstring>            // memset
+#include <exception>          // current_exception, exception_ptr, rethrow_exception
+#include <functional>         // function
+#include <iostream>           // endl, istream, ostream
+#include <iterator>           // make_move_iterator
+#include <limits>             // numeric_limits
+#include <memory>             // make_shared, shared_ptr, unique_ptr
+#include <mutex>              // lock_guard, mutex, unique_lock
+#include <set>                // set
+#include <stdexcept>          // overflow_error, runtime_error
+#include <string>             // string
+#include <thread>             // thread
+#include <type_traits>        // make_unsigned
+#include <utility>            // make_pair, pair
+#include <vector>             // vector
+
+#include <fcntl.h>      // open, O_CREAT, O_RDWR
+#include <sys/file.h>   // flock, LOCK_EX, LOCK_SH, LOCK_UN
+#include <sys/mman.h>   // madvise, mmap, munmap
+#include <sys/socket.h> // accept, bind, connect, listen, send, setsockopt, shutdown, socket, MSG_NOSIGNAL, SO_NOSIGPIPE
+#include <sys/stat.h>   // fstat, lstat, stat, S_ISREG, S_ISSOCK
+#include <sys/un.h>     // sockaddr_un
+#include <unistd.h>     // close, fdatasync, lseek, pread, pwrite, read, unlink, write
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define COLLATZ_AVX2
+#include <immintrin.h> // _mm256_*
+#endif
 
 #include "Collatz.h"
 
 using namespace std;
 
+// ---------------
+// collatz_advance
+// ---------------
+
+void collatz_advance_scalar (uint64_t* n, uint16_t* s, size_t count, uint64_t floor) {
+    assert(floor >= 2);
+    for (size_t k = 0; k != count; ++k) {
+        uint64_t m = n[k];
+        uint16_t c = 0;
+        while ((m >= floor) && (m <= collatz_guard)) {
+            m = ((m % 2) == 0) ? (m / 2) : ((3 * m) + 1);
+            ++c;}
+        n[k] = m;
+        s[k] = c;}}
+
+#ifdef COLLATZ_AVX2
+
+namespace {
+
+// two vectors of four lanes each, to hide the latency of a step
+__attribute__((target("avx2")))
+void advance_avx2 (uint64_t* n, uint16_t* s, size_t count, uint64_t floor) {
+    const size_t lanes = 8;
+    alignas(32) uint64_t v[lanes];    // the value in each lane
+    alignas(32) uint64_t c[lanes];    // the steps taken by each lane
+    alignas(32) uint64_t live[lanes]; // all ones if the lane holds a value
+    size_t               which[lanes];
+    size_t               next   = 0;
+    size_t               active = 0;
+    for (size_t l = 0; l != lanes; ++l) {
+        c[l] = 0;
+        if (next != count) {
+            which[l] = next;
+            v[l]     = n[next++];
+            live[l]  = ~uint64_t(0);
+            ++active;}
+        else {
+            v[l]    = floor;
+            live[l] = 0;}}
+    const __m256i f   = _mm256_set1_epi64x(floor);
+    const __m256i g   = _mm256_set1_epi64x(collatz_guard);
+    const __m256i one = _mm256_set1_epi64x(1);
+    __m256i x[2];
+    __m256i y[2];
+    __m256i m[2];
+    for (int h = 0; h != 2; ++h) {
+        x[h] = _mm256_load_si256(reinterpret_cast<const __m256i*>(v    + (4 * h)));
+        y[h] = _mm256_load_si256(reinterpret_cast<const __m256i*>(c    + (4 * h)));
+        m[h] = _mm256_load_si256(reinterpret_cast<const __m256i*>(live + (4 * h)));}
+    while (active != 0) {
+        int done = 0;
+        for (int h = 0; h != 2; ++h) {
+            const __m256i d = _mm256_and_si256(m[h], _mm256_or_si256(_mm256_cmpgt_epi64(f, x[h]), _mm256_cmpgt_epi64(x[h], g)));
+            done |= _mm256_movemask_pd(_mm256_castsi256_pd(d)) << (4 * h);}
+        if (done != 0) {
+            for (int h = 0; h != 2; ++h) {
+                _mm256_store_si256(reinterpret_cast<__m256i*>(v + (4 * h)), x[h]);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(c + (4 * h)), y[h]);}
+            for (size_t l = 0; l != lanes; ++l) {
+                if ((done & (1 << l)) == 0)
+                    continue;
+                n[which[l]] = v[l];
+                s[which[l]] = uint16_t(c[l]);
+                c[l]        = 0;
+                if (next != count) {
+                    which[l] = next;
+                    v[l]     = n[next++];}
+                else {
+                    v[l]    = floor;
+                    live[l] = 0;
+                    --active;}}
+            for (int h = 0; h != 2; ++h) {
+                x[h] = _mm256_load_si256(reinterpret_cast<const __m256i*>(v    + (4 * h)));
+                y[h] = _mm256_load_si256(reinterpret_cast<const __m256i*>(c    + (4 * h)));
+                m[h] = _mm256_load_si256(reinterpret_cast<const __m256i*>(live + (4 * h)));}
+            continue;}
+        // n / 2 if even, 3n + 1 if odd, a few steps per check of the lanes;
+        // a lane that finishes in between is frozen by its mask
+        for (int r = 0; r != 8; ++r)
+            for (int h = 0; h != 2; ++h) {
+                const __m256i d   = _mm256_or_si256(_mm256_cmpgt_epi64(f, x[h]), _mm256_cmpgt_epi64(x[h], g));
+                const __m256i a   = _mm256_andnot_si256(d, m[h]);
+                const __m256i odd = _mm256_cmpeq_epi64(_mm256_and_si256(x[h], one), one);
+                const __m256i e   = _mm256_srli_epi64(x[h], 1);
+                const __m256i o   = _mm256_add_epi64(_mm256_add_epi64(x[h], _mm256_slli_epi64(x[h], 1)), one);
+                x[h] = _mm256_blendv_epi8(x[h], _mm256_blendv_epi8(e, o, odd), a);
+                y[h] = _mm256_sub_epi64(y[h], a);}}}
+
+bool has_avx2 () {
+    static const bool b = __builtin_cpu_supports("avx2");
+    return b;}
+
+} // namespace
+
+#endif // COLLATZ_AVX2
+
+void collatz_advance (uint64_t* n, uint16_t* s, size_t count, uint64_t floor) {
+    assert(floor >= 2);
+#ifdef COLLATZ_AVX2
+    if (has_avx2()) {
+        advance_avx2(n, s, count, floor);
+        return;}
+#endif
+    collatz_advance_scalar(n, s, count, floor);}
+
+// -------------
+// collatz_stats
+// -------------
+
+collatz_stats& collatz_stats::operator += (const collatz_stats& rhs) {
+    for (int p = 0; p != collatz_phases; ++p) {
+        calls[p] += rhs.calls[p];
+        ns[p]    += rhs.ns[p];
+        for (int b = 0; b != buckets; ++b)
+            histogram[p][b] += rhs.histogram[p][b];}
+    hits   += rhs.hits;
+    misses += rhs.misses;
+    steps  += rhs.steps;
+    return *this;}
+
+#ifdef COLLATZ_STATS
+
+namespace {
+
+// the stats of the live threads, and the sum of the finished ones
+// never destroyed, so a thread may finish after the statics
+struct stats_registry {
+    mutex               m;
+    set<collatz_stats*> live;
+    collatz_stats       finished;};
+
+stats_registry& registry () {
+    static stats_registry* r = new stats_registry();
+    return *r;}
+
+struct stats_slot {
+    collatz_stats s;
+
+    stats_slot () {
+        stats_registry&   r = registry();
+        lock_guard<mutex> l(r.m);
+        r.live.insert(&s);}
+
+    ~stats_slot () {
+        stats_registry&   r = registry();
+        lock_guard<mutex> l(r.m);
+        r.finished += s;
+        r.live.erase(&s);}};
+
+collatz_stats& local_stats () {
+    thread_local stats_slot t;
+    return t.s;}
+
+// times the enclosing scope into phase p
+class stats_timer {
+    private:
+        collatz_phase                    _p;
+        chrono::steady_clock::time_point _b;
+
+    public:
+        explicit stats_timer (collatz_phase p) :
+                _p (p),
+                _b (chrono::steady_clock::now())
+            {}
+
+        ~stats_timer () {
+            const uint64_t n = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - _b).count();
+            collatz_stats& s = local_stats();
+            ++s.calls[_p];
+            s.ns[_p] += n;
+            const int      b = (n == 0) ? 0 : (63 - __builtin_clzll(n));
+            ++s.histogram[_p][min(b, collatz_stats::buckets - 1)];}};
+
+} // namespace
+
+#define COLLATZ_TIME(p)     stats_timer collatz_timer_(p)
+#define COLLATZ_COUNT(f, n) (local_stats().f += (n))
+
+bool collatz_stats_enabled () {
+    return true;}
+
+collatz_stats collatz_stats_collect () {
+    stats_registry&   r = registry();
+    lock_guard<mutex> l(r.m);
+    collatz_stats     s = r.finished;
+    for (const collatz_stats* t : r.live)
+        s += *t;
+    return s;}
+
+void collatz_stats_reset () {
+    stats_registry&   r = registry();
+    lock_guard<mutex> l(r.m);
+    r.finished = collatz_stats();
+    for (collatz_stats* t : r.live)
+        *t = collatz_stats();}
+
+#else
+
+#define COLLATZ_TIME(p)
+#define COLLATZ_COUNT(f, n)
+
+bool collatz_stats_enabled () {
+    return false;}
+
+collatz_stats collatz_stats_collect () {
+    return collatz_stats();}
+
+void collatz_stats_reset ()
+    {}
+
+#endif // COLLATZ_STATS
+
+void collatz_stats_dump (ostream& w, const collatz_stats& s) {
+    const char* const names[collatz_phases] = {"read", "eval", "print"};
+    w << "enabled " << (collatz_stats_enabled() ? 1 : 0) << "\n";
+    for (int p = 0; p != collatz_phases; ++p) {
+        // the percentiles are the upper bounds of their buckets
+        uint64_t q[2] = {0, 0};
+        uint64_t c    = 0;
+        for (int b = 0; b != collatz_stats::buckets; ++b) {
+            c += s.histogram[p][b];
+            if ((q[0] == 0) && ((2 * c) >= s.calls[p]) && (c != 0))
+                q[0] = uint64_t(2) << b;
+            if ((q[1] == 0) && ((100 * c) >= (99 * s.calls[p])) && (c != 0))
+                q[1] = uint64_t(2) << b;}
+        w << names[p] << ".calls "     << s.calls[p] << "\n"
+          << names[p] << ".ns "        << s.ns[p]    << "\n"
+          << names[p] << ".p50_ns "    << q[0]       << "\n"
+          << names[p] << ".p99_ns "    << q[1]       << "\n"
+          << names[p] << ".histogram";
+        for (int b = 0; b != collatz_stats::buckets; ++b)
+            w << " " << s.histogram[p][b];
+        w << "\n";}
+    w << "cache.hits "   << s.hits   << "\n"
+      << "cache.misses " << s.misses << "\n"
+      << "cache.steps "  << s.steps  << endl;}
+
+// -------------
+// collatz_cache
+// -------------
+
+namespace {
+
+// keys must leave the low 16 bits of a hash entry to the value
+const uint64_t hash_key_limit = uint64_t(1) << 48;
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+// the shortcut map, T(n) = n / 2 if n is even, (3n + 1) / 2 if n is odd,
+// k steps at a time: T^k(a * 2^k + b) = 3^c(b) * a + d(b), where c(b) of the k steps are odd
+// and the cycle length drops by k + c(b)
+const int      jump_bits = 12;
+const uint64_t jump_size = uint64_t(1) << jump_bits;
+
+struct jump {
+    uint32_t c;
+    uint32_t d;};
+
+struct jump_table {
+    jump      t[jump_size];
+    uint64_t  pow3[jump_bits + 1];
+    uint128_t limit[jump_bits + 1]; // the largest a that doesn't overflow
+
+    jump_table () {
+        pow3[0] = 1;
+        for (int c = 1; c <= jump_bits; ++c)
+            pow3[c] = 3 * pow3[c - 1];
+        for (int c = 0; c <= jump_bits; ++c)
+            limit[c] = (~uint128_t(0) - numeric_limits<uint32_t>::max()) / pow3[c];
+        for (uint64_t b = 0; b != jump_size; ++b) {
+            uint64_t d = b;
+            uint32_t c = 0;
+            for (int k = 0; k != jump_bits; ++k)
+                if ((d % 2) == 0)
+                    d /= 2;
+                else {
+                    d = ((3 * d) + 1) / 2;
+                    ++c;}
+            t[b].c = c;
+            t[b].d = uint32_t(d);}}};
+
+const jump_table& jumps () {
+    static const jump_table j;
+    return j;}
+
+inline size_t hash_slot (uint64_t n, size_t size) {
+    return ((n * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);}
+
+// a small id per thread, to spread the counters
+inline size_t thread_shard () {
+    static atomic<size_t>     next(0);
+    thread_local const size_t id = next++;
+    return id;}
+
+inline size_t floor_pow2 (size_t n) {
+    size_t p = 1;
+    while ((p * 2) <= n)
+        p *= 2;
+    return p;}
+
+} // namespace
+
+collatz_cache::collatz_cache (size_type budget) :
+        _dense  (max<size_type>(2, (budget / 2) / sizeof(value_type))),
+        _hash   (floor_pow2(max<size_type>(1, (budget / 2) / sizeof(uint64_t)))),
+        _filled (2),
+        _fill   () {
+    for (counters& t : _counters) {
+        t.hits   = 0;
+        t.misses = 0;}
+    _dense[1] = 1;}
+
+collatz_cache::value_type collatz_cache::lookup (uint64_t n) const {
+    if (n < _dense.size())
+        return _dense[n].load(memory_order_relaxed);
+    if (n >= hash_key_limit)
+        return 0;
+    const uint64_t e = _hash[hash_slot(n, _hash.size())].load(memory_order_relaxed);
+    return ((e >> 16) == n) ? value_type(e) : 0;}
+
+void collatz_cache::store (uint64_t n, value_type v) {
+    if (n < _dense.size())
+        _dense[n].store(v, memory_order_relaxed);
+    else if (n < hash_key_limit)
+        _hash[hash_slot(n, _hash.size())].store((n << 16) | v, memory_order_relaxed);}
+
+int collatz_cache::cycle_length (uint64_t n) {
+    assert(n > 0);
+    counters& t = _counters[thread_shard() % shards];
+    value_type v = lookup(n);
+    if (v != 0) {
+        t.hits.fetch_add(1, memory_order_relaxed);
+        COLLATZ_COUNT(hits, 1);
+        return v;}
+    t.misses.fetch_add(1, memory_order_relaxed);
+    COLLATZ_COUNT(misses, 1);
+    // each value walked, 0 if it doesn't fit in 64 bits, and the steps from it to the next
+    thread_local vector<pair<uint64_t, uint16_t>> path;
+    path.clear();
+    const jump_table& j = jumps();
+    const uint64_t    z = max<uint64_t>(_dense.size(), jump_size);
+    uint128_t         m = n;
+    while (v == 0) {
+        const uint64_t w = ((m >> 64) == 0) ? uint64_t(m) : 0;
+        uint16_t       s;
+        if (m < z) {
+            s = 1;
+            m = ((m % 2) == 0) ? (m / 2) : ((3 * m) + 1);}
+        else {
+            const jump&     p = j.t[uint64_t(m) & (jump_size - 1)];
+            const uint128_t a = m >> jump_bits;
+            if (a > j.limit[p.c])
+                throw overflow_error("collatz_cache: the walk overflows 128 bits");
+            s = uint16_t(jump_bits + p.c);
+            m = (a * j.pow3[p.c]) + p.d;}
+        path.push_back(make_pair(w, s));
+        COLLATZ_COUNT(steps, s);
+        v = ((m >> 64) == 0) ? lookup(uint64_t(m)) : 0;}
+    while (!path.empty()) {
+        v += path.back().second;
+        if (path.back().first != 0)
+            store(path.back().first, v);
+        path.pop_back();}
+    assert(v > 0);
+    return v;}
+
+void collatz_cache::fill (uint64_t n) {
+    const size_type e = min<uint64_t>(n + 1, _dense.size());
+    if (_filled.load(memory_order_acquire) >= e)
+        return;
+    lock_guard<mutex> l(_fill);
+    const size_type   z = 4096;
+    vector<uint64_t>  ns(z);
+    vector<uint16_t>  ss(z);
+    for (size_type b = _filled.load(memory_order_relaxed); b < e; b += z) {
+        const size_type m = min(e - b, z);
+        for (size_type k = 0; k != m; ++k)
+            ns[k] = b + k;
+        // every value below b is known
+        collatz_advance(ns.data(), ss.data(), m, b);
+        for (size_type k = 0; k != m; ++k) {
+            const int v = (ns[k] < b) ? lookup(ns[k]) : cycle_length(ns[k]);
+            store(b + k, value_type(v + ss[k]));
+            COLLATZ_COUNT(steps, ss[k]);}
+        _filled.store(b + m, memory_order_release);}}
+
+collatz_cache::size_type collatz_cache::hits () const {
+    size_type s = 0;
+    for (const counters& t : _counters)
+        s += t.hits.load(memory_order_relaxed);
+    return s;}
+
+collatz_cache::size_type collatz_cache::misses () const {
+    size_type s = 0;
+    for (const counters& t : _counters)
+        s += t.misses.load(memory_order_relaxed);
+    return s;}
+
+// -------------
+// collatz_index
+// -------------
+
+const collatz_index::size_type collatz_index::span;
+
+collatz_index::collatz_index (collatz_cache& c, size_type bound, size_type block) :
+        _c      (c),
+        _bound  (bound),
+        _block  (max<size_type>(block, 1)),
+        _own    (),
+        _maxima (nullptr),
+        _table  () {
+    if (_bound > 1)
+        _c.fill(_bound - 1);
+    _own.resize(blocks());
+    for (size_type k = 1; k < _bound; ++k) {
+        value_type& m = _own[k / _block];
+        m = max<value_type>(m, _c.cycle_length(k));}
+    _maxima = _own.data();
+    build();}
+
+collatz_index::collatz_index (collatz_cache& c, const value_type* maxima, size_type bound, size_type block) :
+        _c      (c),
+        _bound  (bound),
+        _block  (max<size_type>(block, 1)),
+        _own    (),
+        _maxima (maxima),
+        _table  () {
+    build();}
+
+// the sparse table over the maxima of the whole spans; the blocks of a last, partial span are read directly
+void collatz_index::build () {
+    const size_type n = blocks() / span;
+    if (n == 0)
+        return;
+    _table.push_back(vector<value_type>(n));
+    for (size_type k = 0; k != n; ++k)
+        _table[0][k] = *max_element(_maxima + (k * span), _maxima + ((k + 1) * span));
+    for (size_type w = 1; (2 * w) <= n; w *= 2) {
+        const vector<value_type>& p = _table.back();
+        vector<value_type>        q(n - (2 * w) + 1);
+        for (size_type b = 0; b != q.size(); ++b)
+            q[b] = max(p[b], p[b + w]);
+        _table.push_back(q);}}
+
+int collatz_index::scan (uint64_t i, uint64_t j) {
+    int v = 0;
+    for (uint64_t n = i; n <= j; ++n)
+        v = max(v, _c.cycle_length(n));
+    return v;}
+
+// the max of the blocks [b, e), b < e
+int collatz_index::whole (uint64_t b, uint64_t e) const {
+    const uint64_t sb = (b + span - 1) / span;
+    const uint64_t se = e / span;
+    if (sb >= se)
+        return *max_element(_maxima + b, _maxima + e);
+    int v = 0;
+    if (b != (sb * span))
+        v = *max_element(_maxima + b, _maxima + (sb * span));
+    if (e != (se * span))
+        v = max<int>(v, *max_element(_maxima + (se * span), _maxima + e));
+    size_type k = 0;
+    while ((uint64_t(2) << k) <= (se - sb))
+        ++k;
+    const vector<value_type>& t = _table[k];
+    return max<int>(v, max(t[sb], t[se - (uint64_t(1) << k)]));}
+
+int collatz_index::query (uint64_t i, uint64_t j) {
+    assert(i > 0);
+    assert(i <= j);
+    if (j >= _bound) {
+        const int v = scan(max<uint64_t>(i, _bound), j);
+        return (i < _bound) ? max(v, query(i, _bound - 1)) : v;}
+    const uint64_t bi = i / _block;
+    const uint64_t bj = j / _block;
+    if (bi == bj)
+        return scan(i, j);
+    int v = max(scan(i, ((bi + 1) * _block) - 1), scan(bj * _block, j));
+    if ((bi + 1) < bj)
+        v = max(v, whole(bi + 1, bj));
+    return v;}
+
+collatz_index::size_type collatz_index::memory () const {
+    size_type s = _own.size() * sizeof(value_type);
+    for (const vector<value_type>& t : _table)
+        s += t.size() * sizeof(value_type);
+    return s;}
+
+// -------------
+// collatz_store
+// -------------
+
+namespace {
+
+struct store_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t block;
+    uint64_t bound;
+    uint64_t checksum;};
+
+const char     store_magic[8] = {'C', 'O', 'L', 'L', 'A', 'T', 'Z', '\0'};
+const uint32_t store_version  = 1;
+const uint64_t fnv_basis      = 0xCBF29CE484222325ULL;
+
+// FNV-1a, continued from h
+uint64_t fnv1a (uint64_t h, const uint16_t* a, size_t n) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(a);
+    for (size_t k = 0; k != (n * sizeof(uint16_t)); ++k) {
+        h ^= p[k];
+        h *= 0x100000001B3ULL;}
+    return h;}
+
+// holds a flock for its lifetime
+class store_lock {
+    private:
+        int _fd;
+
+    public:
+        store_lock (int fd, int op) :
+                _fd (fd) {
+            while ((flock(_fd, op) != 0) && (errno == EINTR))
+                continue;}
+
+        store_lock             (const store_lock&) = delete;
+        store_lock& operator = (const store_lock&) = delete;
+
+        ~store_lock () {
+            flock(_fd, LOCK_UN);}};
+
+void store_write (int fd, const void* b, size_t n, off_t o) {
+    const char* p = static_cast<const char*>(b);
+    while (n != 0) {
+        const ssize_t k = pwrite(fd, p, n, o);
+        if ((k < 0) && (errno == EINTR))
+            continue;
+        if (k <= 0)
+            throw runtime_error("collatz_store: write failed");
+        p += k;
+        n -= k;
+        o += k;}}
+
+} // namespace
+
+const uint64_t collatz_store::limit;
+
+collatz_store::collatz_store (const string& path, size_t block) :
+        _fd       (open(path.c_str(), O_RDWR | O_CREAT, 0644)),
+        _map      (nullptr),
+        _size     (0),
+        _block    (0),
+        _bound    (0),
+        _checksum (fnv_basis),
+        _maxima   (nullptr) {
+    if (_fd < 0)
+        throw runtime_error("collatz_store: can't open " + path);
+    try {
+        struct stat t;
+        if ((fstat(_fd, &t) == 0) && (t.st_size == 0)) {
+            // another process may be creating it too
+            store_lock l(_fd, LOCK_EX);
+            if ((fstat(_fd, &t) == 0) && (t.st_size == 0)) {
+                store_header h;
+                copy(store_magic, store_magic + 8, h.magic);
+                h.version  = store_version;
+                h.block    = uint32_t(max<size_t>(block, 1));
+                h.bound    = 0;
+                h.checksum = fnv_basis;
+                store_write(_fd, &h, sizeof(h), 0);
+                fdatasync(_fd);}}
+        store_lock l(_fd, LOCK_SH);
+        map();}
+    catch (...) {
+        close(_fd);
+        throw;}}
+
+collatz_store::~collatz_store () {
+    if (_map != nullptr)
+        munmap(_map, _size);
+    close(_fd);}
+
+// the caller holds a flock
+void collatz_store::map () {
+    store_header h;
+    if (pread(_fd, &h, sizeof(h), 0) != ssize_t(sizeof(h)))
+        throw runtime_error("collatz_store: short header");
+    if (!equal(store_magic, store_magic + 8, h.magic) || (h.version != store_version) || (h.block == 0) || ((h.bound % h.block) != 0))
+        throw runtime_error("collatz_store: bad header");
+    const size_t n = sizeof(h) + ((h.bound / h.block) * sizeof(uint16_t));
+    struct stat  t;
+    if ((fstat(_fd, &t) != 0) || (size_t(t.st_size) < n))
+        throw runtime_error("collatz_store: short file");
+    void* m = mmap(nullptr, n, PROT_READ, MAP_SHARED, _fd, 0);
+    if (m == MAP_FAILED)
+        throw runtime_error("collatz_store: mmap failed");
+    const uint16_t* a = reinterpret_cast<const uint16_t*>(static_cast<const char*>(m) + sizeof(h));
+    if (fnv1a(fnv_basis, a, h.bound / h.block) != h.checksum) {
+        munmap(m, n);
+        throw runtime_error("collatz_store: bad checksum");}
+    if (_map != nullptr)
+        munmap(_map, _size);
+    _map      = m;
+    _size     = n;
+    _block    = h.block;
+    _bound    = h.bound;
+    _checksum = h.checksum;
+    _maxima   = a;}
+
+void collatz_store::extend (collatz_cache& c, uint64_t bound) {
+    // another process may already have extended it far enough, which needs only a shared lock to see
+    const auto covered = [&] () {
+        store_lock l(_fd, LOCK_SH);
+        map();
+        return _bound >= bound;};
+    if (covered())
+        return;
+    store_lock l(_fd, LOCK_EX);
+    map();
+    if (_bound >= bound)
+        return;
+    const size_t     b = _bound / _block;
+    const size_t     e = (bound + _block - 1) / _block;
+    vector<uint16_t> m(e - b);
+    c.fill((e * _block) - 1);
+    for (size_t k = b; k != e; ++k)
+        for (uint64_t n = max<uint64_t>(1, k * _block); n != ((k + 1) * _block); ++n)
+            m[k - b] = max<uint16_t>(m[k - b], c.cycle_length(n));
+    store_write(_fd, m.data(), m.size() * sizeof(uint16_t), sizeof(store_header) + (b * sizeof(uint16_t)));
+    fdatasync(_fd);
+    store_header h;
+    copy(store_magic, store_magic + 8, h.magic);
+    h.version  = store_version;
+    h.block    = uint32_t(_block);
+    h.bound    = e * _block;
+    h.checksum = fnv1a(_checksum, m.data(), m.size());
+    store_write(_fd, &h, sizeof(h), 0);
+    fdatasync(_fd);
+    map();}
+
+// --------------
+// collatz_reader
+// --------------
+
+namespace {
+
+inline bool is_space (char c) {
+    return (c == ' ') || ((c >= '\t') && (c <= '\r'));}
+
+inline bool is_digit (char c) {
+    return (c >= '0') && (c <= '9');}
+
+} // namespace
+
+collatz_reader::collatz_reader (int fd) :
+        _fd     (fd),
+        _map    (nullptr),
+        _size   (0),
+        _buffer (),
+        _p      (nullptr),
+        _e      (nullptr),
+        _eof    (false) {
+    struct stat s;
+    if ((fstat(fd, &s) == 0) && S_ISREG(s.st_mode) && (s.st_size > 0)) {
+        void* m = mmap(nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            madvise(m, s.st_size, MADV_SEQUENTIAL);
+            const off_t o = lseek(fd, 0, SEEK_CUR);
+            _map  = m;
+            _size = s.st_size;
+            _p    = static_cast<const char*>(m) + min<size_t>(max<off_t>(o, 0), _size);
+            _e    = static_cast<const char*>(m) + _size;
+            _eof  = true;
+            return;}}
+    _buffer.resize(chunk);
+    _p = _e = _buffer.data();}
+
+collatz_reader::collatz_reader (const char* b, const char* e) :
+        _fd     (-1),
+        _map    (nullptr),
+        _size   (0),
+        _buffer (),
+        _p      (b),
+        _e      (e),
+        _eof    (true)
+    {}
+
+collatz_reader::~collatz_reader () {
+    if (_map != nullptr)
+        munmap(_map, _size);}
+
+bool collatz_reader::refill () {
+    if (_eof)
+        return false;
+    const size_t n = _e - _p;
+    if (n == _buffer.size()) {
+        // a token that fills the buffer: read on into a larger one, rather than read nothing and stop
+        vector<char> x(2 * n);
+        copy(_p, _e, x.begin());
+        _buffer.swap(x);}
+    else
+        copy(_p, _e, _buffer.begin());
+    char* const b = _buffer.data();
+    ssize_t     k;
+    do
+        k = ::read(_fd, b + n, _buffer.size() - n);
+    while ((k < 0) && (errno == EINTR));
+    if (k <= 0) {
+        _eof = true;
+        k    = 0;}
+    _p = b;
+    _e = b + n + k;
+    return k > 0;}
+
+template <typename T>
+bool collatz_reader::read (T& n) {
+    while (true) {
+        while ((_p != _e) && is_space(*_p))
+            ++_p;
+        if (_p != _e)
+            break;
+        if (!refill())
+            return false;}
+    // the whole token must be in the buffer
+    while (!_eof && (find_if(_p, _e, is_space) == _e))
+        refill();
+    const char* p = _p;
+    const bool  m = (*p == '-');
+    if ((*p == '-') || (*p == '+'))
+        ++p;
+    if ((p == _e) || !is_digit(*p))
+        return false;
+    const uint64_t l = uint64_t(numeric_limits<T>::max()) + (m ? 1 : 0);
+    uint64_t       v = 0;
+    bool           o = false;
+    while ((p != _e) && is_digit(*p)) {
+        const int d = *p - '0';
+        if (v > ((l - d) / 10))
+            o = true;
+        else
+            v = (10 * v) + d;
+        ++p;}
+    if (o)
+        return false;
+    n  = m ? T(0 - v) : T(v);
+    _p = p;
+    return true;}
+
+template bool collatz_reader::read<int>       (int&);
+template bool collatz_reader::read<long long> (long long&);
+
+// --------------
+// collatz_writer
+// --------------
+
+collatz_writer::collatz_writer (int fd) :
+        _fd     (fd),
+        _socket (false),
+        _buffer () {
+    struct stat s;
+    _socket = (fstat(fd, &s) == 0) && S_ISSOCK(s.st_mode);
+    _buffer.reserve(collatz_reader::chunk + 16);}
+
+collatz_writer::~collatz_writer () {
+    // a destructor can't report the error; call flush first to see it
+    try {
+        flush();}
+    catch (const runtime_error&)
+        {}}
+
+template <typename T>
+void collatz_writer::write (T n, char c) {
+    using U = typename make_unsigned<T>::type;
+    char  d[24];
+    char* p = d + 24;
+    U     u = (n < 0) ? U(0) - U(n) : U(n);
+    do {
+        *--p = char('0' + (u % 10));
+        u /= 10;}
+    while (u != 0);
+    if (n < 0)
+        *--p = '-';
+    _buffer.insert(_buffer.end(), p, d + 24);
+    _buffer.push_back(c);
+    if (_buffer.size() >= collatz_reader::chunk)
+        flush();}
+
+template void collatz_writer::write<int>       (int,       char);
+template void collatz_writer::write<long long> (long long, char);
+
+void collatz_writer::flush () {
+    const char* p = _buffer.data();
+    size_t      n = _buffer.size();
+    while (n != 0) {
+#ifdef MSG_NOSIGNAL
+        const ssize_t k = _socket ? send(_fd, p, n, MSG_NOSIGNAL) : ::write(_fd, p, n);
+#else
+        // SO_NOSIGPIPE, set on the socket, does the same
+        const ssize_t k = ::write(_fd, p, n);
+#endif
+        if ((k < 0) && (errno == EINTR))
+            continue;
+        if (k <= 0) {
+            _buffer.clear();
+            throw runtime_error("collatz_writer: write failed");}
+        p += k;
+        n -= k;}
+    _buffer.clear();}
+
 // ------------
 // collatz_read
 // ------------
 
-bool collatz_read (istream& r, int& i, int& j) {
+template <typename T>
+bool collatz_read (istream& r, T& i, T& j) {
+    COLLATZ_TIME(collatz_phase_read);
     if (!(r >> i))
         return false;
-    r >> j;
+    // at the end of the input, >> leaves j as it was
+    if (!(r >> j))
+        j = 0;
+    return true;}
+
+template <typename T>
+bool collatz_read (collatz_reader& r, T& i, T& j) {
+    COLLATZ_TIME(collatz_phase_read);
+    if (!r.read(i))
+        return false;
+    if (!r.read(j))
+        j = 0;
     return true;}
 
+template bool collatz_read<int>       (istream&,        int&,       int&);
+template bool collatz_read<long long> (istream&,        long long&, long long&);
+template bool collatz_read<int>       (collatz_reader&, int&,       int&);
+template bool collatz_read<long long> (collatz_reader&, long long&, long long&);
+
 // ------------
 // collatz_eval
 // ------------
 
-int collatz_eval (int i, int j) {
-    // <your code>
-    return 1;}
+template <typename T>
+int collatz_eval (collatz_cache& c, T i, T j) {
+    COLLATZ_TIME(collatz_phase_eval);
+    assert(i > 0);
+    assert(j > 0);
+    if (i > j)
+        swap(i, j);
+    // for every n < j / 2 + 1, 2n is also in the range, with a longer cycle
+    i = max(i, T((j / 2) + 1));
+    c.fill(j);
+    int v = 0;
+    for (uint64_t n = i; n <= uint64_t(j); ++n)
+        v = max(v, c.cycle_length(n));
+    assert(v > 0);
+    return v;}
+
+template <typename T>
+int collatz_eval (T i, T j) {
+    static collatz_cache c;
+    return collatz_eval(c, i, j);}
+
+template <typename T>
+int collatz_eval (collatz_index& x, T i, T j) {
+    COLLATZ_TIME(collatz_phase_eval);
+    assert(i > 0);
+    assert(j > 0);
+    if (i > j)
+        swap(i, j);
+    i = max(i, T((j / 2) + 1));
+    const int v = x.query(i, j);
+    assert(v > 0);
+    return v;}
+
+template int collatz_eval<int>       (collatz_cache&, int,       int);
+template int collatz_eval<long long> (collatz_cache&, long long, long long);
+template int collatz_eval<int>       (int,       int);
+template int collatz_eval<long long> (long long, long long);
+template int collatz_eval<int>       (collatz_index&, int,       int);
+template int collatz_eval<long long> (collatz_index&, long long, long long);
 
 // -------------
 // collatz_print
 // -------------
 
-void collatz_print (ostream& w, int i, int j, int v) {
+template <typename T>
+void collatz_print (ostream& w, T i, T j, int v) {
+    COLLATZ_TIME(collatz_phase_print);
     w << i << " " << j << " " << v << endl;}
 
+template <typename T>
+void collatz_print (collatz_writer& w, T i, T j, int v) {
+    COLLATZ_TIME(collatz_phase_print);
+    w.write(i, ' ');
+    w.write(j, ' ');
+    w.write(v, '\n');}
+
+template void collatz_print<int>       (ostream&,        int,       int,       int);
+template void collatz_print<long long> (ostream&,        long long, long long, int);
+template void collatz_print<int>       (collatz_writer&, int,       int,       int);
+template void collatz_print<long long> (collatz_writer&, long long, long long, int);
+
+// ------------
+// collatz_pool
+// ------------
+
+bool collatz_pool::take (size_t w, size_t& k) {
+    slice&            s = *_slices[w];
+    lock_guard<mutex> l(s.m);
+    if (s.b == s.e)
+        return false;
+    k = s.b++;
+    return true;}
+
+// moves the back half of slice v into b, e
+bool collatz_pool::split (size_t v, size_t& b, size_t& e) {
+    slice&            s = *_slices[v];
+    lock_guard<mutex> l(s.m);
+    if (s.b == s.e)
+        return false;
+    e   = s.e;
+    b   = e - ((s.e - s.b + 1) / 2);
+    s.e = b;
+    return true;}
+
+bool collatz_pool::steal (size_t w) {
+    const size_t n = _slices.size();
+    size_t b;
+    size_t e;
+    for (size_t d = 1; d != n; ++d)
+        if (split((w + d) % n, b, e)) {
+            slice&            s = *_slices[w];
+            lock_guard<mutex> l(s.m);
+            s.b = b;
+            s.e = e;
+            return true;}
+    return false;}
+
+// an exception leaves the rest of w's slice to be stolen
+void collatz_pool::work (size_t w) {
+    try {
+        size_t k;
+        do {
+            while (take(w, k))
+                (*_f)(k);}
+        while (steal(w));}
+    catch (...) {
+        lock_guard<mutex> l(_m);
+        if (!_error)
+            _error = current_exception();}}
+
+void collatz_pool::loop (size_t w) {
+    size_t g = 0;
+    while (true) {
+        unique_lock<mutex> l(_m);
+        _go.wait(l, [&] () {return _stop || (_generation != g);});
+        if (_stop)
+            return;
+        g = _generation;
+        l.unlock();
+        work(w);
+        l.lock();
+        if (--_busy == 0)
+            _done.notify_one();}}
+
+collatz_pool::collatz_pool (size_t n) :
+        _threads    (),
+        _slices     (),
+        _f          (nullptr),
+        _generation (0),
+        _busy       (0),
+        _stop       (false),
+        _error      () {
+    assert(n > 0);
+    for (size_t w = 0; w != n; ++w)
+        _slices.push_back(unique_ptr<slice>(new slice()));
+    for (size_t w = 1; w != n; ++w)
+        _threads.push_back(thread(&collatz_pool::loop, this, w));}
+
+collatz_pool::~collatz_pool () {
+    unique_lock<mutex> l(_m);
+    _stop = true;
+    l.unlock();
+    _go.notify_all();
+    for (thread& t : _threads)
+        t.join();}
+
+void collatz_pool::run (size_t n, const function<void (size_t)>& f) {
+    const size_t       t = _slices.size();
+    unique_lock<mutex> l(_m);
+    for (size_t w = 0; w != t; ++w) {
+        slice&            s = *_slices[w];
+        lock_guard<mutex> m(s.m);
+        s.b = (n * w)       / t;
+        s.e = (n * (w + 1)) / t;}
+    _f     = &f;
+    _busy  = t - 1;
+    _error = nullptr;
+    ++_generation;
+    l.unlock();
+    _go.notify_all();
+    work(0);
+    l.lock();
+    _done.wait(l, [&] () {return _busy == 0;});
+    if (_error) {
+        exception_ptr e = nullptr;
+        swap(e, _error);
+        rethrow_exception(e);}}
+
+namespace {
+
+// the number of queries read, evaluated and printed at a time
+const size_t collatz_batch = 4096;
+
+} // namespace
+
 // -------------
 // collatz_solve
 // -------------
 
+namespace {
+
+// the least a store grows by
+const uint64_t store_step = uint64_t(1) << 20;
+
+// makes x the index of o, if it has one
+// with a store, a j within twice its bound grows it to cover j, at most doubling it;
+// a j further out is left to x to scan past the store's end, so one far query costs
+// its own range, not every cycle length below it
+void select_index (collatz_cache& c, unique_ptr<collatz_index>& x, const collatz_options& o, uint64_t j) {
+    if (o.store != nullptr) {
+        collatz_store& s = *o.store;
+        if ((s.bound() <= j) && (s.bound() < collatz_store::limit) && (j < max(2 * uint64_t(s.bound()), store_step))) {
+            // the remap frees the maxima that x reads
+            x.reset();
+            s.extend(c, min(max<uint64_t>(j + 1, 2 * s.bound()), collatz_store::limit));}
+        if (!x)
+            x.reset(new collatz_index(c, s.maxima(), s.bound(), s.block()));}
+    else if (x || (o.mode != collatz_indexed))
+        return;
+    else if (o.table != nullptr)
+        x.reset(new collatz_index(c, o.table, o.bound, o.block));
+    else
+        x.reset(new collatz_index(c, o.bound, o.block));}
+
+// T is the integer width
+// R and W are an istream and an ostream, or a collatz_reader and a collatz_writer
+template <typename T, typename R, typename W>
+void solve (R& r, W& w, const collatz_options& o) {
+    unique_ptr<collatz_cache> d;
+    if (o.cache == nullptr)
+        d.reset(new collatz_cache);
+    collatz_cache&            c = (o.cache != nullptr) ? *o.cache : *d;
+    unique_ptr<collatz_index> x;
+    select_index(c, x, o, 0);
+    const size_t t = (o.threads != 0) ? o.threads : max<size_t>(1, thread::hardware_concurrency());
+    T i;
+    T j;
+    if (t == 1) {
+        while (collatz_read(r, i, j)) {
+            select_index(c, x, o, max(i, j));
+            const int v = x ? collatz_eval(*x, i, j) : collatz_eval(c, i, j);
+            collatz_print(w, i, j, v);}
+        return;}
+    collatz_pool                  p(t);
+    vector<T>                     is;
+    vector<T>                     js;
+    vector<int>                   vs;
+    const function<void (size_t)> f = [&] (size_t k) {
+        vs[k] = x ? collatz_eval(*x, is[k], js[k]) : collatz_eval(c, is[k], js[k]);};
+    bool b = true;
+    while (b) {
+        is.clear();
+        js.clear();
+        T m = 0;
+        while ((is.size() != collatz_batch) && (b = collatz_read(r, i, j))) {
+            is.push_back(i);
+            js.push_back(j);
+            m = max(m, max(i, j));}
+        select_index(c, x, o, m);
+        vs.resize(is.size());
+        p.run(is.size(), f);
+        for (size_t k = 0; k != is.size(); ++k)
+            collatz_print(w, is[k], js[k], vs[k]);}}
+
+} // namespace
+
+template <typename T>
+void collatz_solve (istream& r, ostream& w, const collatz_options& o) {
+    solve<T>(r, w, o);}
+
+template <typename T>
 void collatz_solve (istream& r, ostream& w) {
-    int i;
-    int j;
-    while (collatz_read(r, i, j)) {
-        const int v = collatz_eval(i, j);
-        collatz_print(w, i, j, v);}}
+    collatz_solve<T>(r, w, collatz_options());}
+
+template <typename T>
+void collatz_solve (int r, int w, const collatz_options& o) {
+    collatz_reader x(r);
+    collatz_writer y(w);
+    solve<T>(x, y, o);
+    y.flush();}
+
+template void collatz_solve<int>       (istream&, ostream&, const collatz_options&);
+template void collatz_solve<long long> (istream&, ostream&, const collatz_options&);
+template void collatz_solve<int>       (istream&, ostream&);
+template void collatz_solve<long long> (istream&, ostream&);
+template void collatz_solve<int>       (int, int, const collatz_options&);
+template void collatz_solve<long long> (int, int, const collatz_options&);
+
+// --------------
+// collatz_server
+// --------------
+
+namespace {
+
+// after stop, how long a client that isn't reading has to take its answers
+const chrono::seconds server_linger(1);
+
+} // namespace
+
+// read and write are the connection's own threads; evaluate hands write the answers through m
+struct collatz_server::connection {
+    struct answer {
+        long long i;
+        long long j;
+        int       v;};
+
+    int                fd;
+    mutex              m;
+    condition_variable changed;
+    vector<answer>     answers; // evaluated, not yet written
+    size_t             pending; // read, not yet written or dropped
+    bool               ended;   // every range has been evaluated
+    bool               failed;  // a range's walk overflowed; touched only by evaluate
+
+    explicit connection (int f) :
+            fd      (f),
+            m       (),
+            changed (),
+            answers (),
+            pending (0),
+            ended   (false),
+            failed  (false)
+        {}};
+
+collatz_server::collatz_server (const string& path, const collatz_options& o, size_t depth) :
+        _path    (path),
+        _options (o),
+        _depth   (max<size_t>(depth, 1)),
+        _listen  (-1),
+        _cache   (),
+        _index   (),
+        _readers (0),
+        _writers (0),
+        _stop    (false),
+        _done    (false),
+        _batches (0),
+        _ranges  (0) {
+    sockaddr_un a;
+    memset(&a, 0, sizeof(a));
+    a.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(a.sun_path))
+        throw runtime_error("collatz_server: path too long " + path);
+    copy(path.begin(), path.end(), a.sun_path);
+    struct stat s;
+    if ((lstat(path.c_str(), &s) == 0) && S_ISSOCK(s.st_mode))
+        unlink(path.c_str());
+    _listen = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_listen == -1)
+        throw runtime_error("collatz_server: socket failed");
+    if ((bind(_listen, reinterpret_cast<const sockaddr*>(&a), sizeof(a)) == -1) || (listen(_listen, SOMAXCONN) == -1)) {
+        close(_listen);
+        throw runtime_error("collatz_server: can't listen on " + path);}
+    select_index(_cache, _index, _options, 0);}
+
+collatz_server::~collatz_server () {
+    for (pair<const thread::id, thread>& t : _threads)
+        t.second.join();
+    close(_listen);
+    unlink(_path.c_str());}
+
+// after stop, a full queue takes the entry anyway, so that every reader can finish
+void collatz_server::push (entry e) {
+    unique_lock<mutex> l(_m);
+    _not_full.wait(l, [&] () {return (_queue.size() < _depth) || _stop;});
+    _queue.push_back(move(e));
+    l.unlock();
+    _not_empty.notify_one();}
+
+void collatz_server::read (shared_ptr<connection> c) {
+    collatz_reader r(c->fd);
+    long long      i;
+    long long      j;
+    // a range cut short reads j as 0
+    while (collatz_read(r, i, j) && (i > 0) && (j > 0)) {
+        // a client that doesn't read its answers stops here, not in the queue
+        unique_lock<mutex> l(c->m);
+        c->changed.wait(l, [&] () {return (c->pending < _depth) || _stop;});
+        ++c->pending;
+        l.unlock();
+        push(entry {c, i, j});}
+    push(entry {c, 0, 0});
+    c.reset();
+    lock_guard<mutex> l(_m);
+    --_readers;
+    _finished.push_back(this_thread::get_id());
+    _idle.notify_all();}
+
+void collatz_server::write (shared_ptr<connection> c) {
+    collatz_writer w(c->fd);
+    vector<connection::answer> as;
+    bool                       gone = false;
+    while (true) {
+        unique_lock<mutex> l(c->m);
+        c->pending -= as.size();
+        as.clear();
+        c->changed.notify_all();
+        c->changed.wait(l, [&] () {return !c->answers.empty() || c->ended;});
+        if (c->answers.empty())
+            break;
+        as.swap(c->answers);
+        l.unlock();
+        // a client that has gone away loses only its own answers
+        if (!gone)
+            try {
+                for (const connection::answer& a : as)
+                    collatz_print(w, a.i, a.j, a.v);
+                w.flush();}
+            catch (const runtime_error&) {
+                gone = true;}}
+    lock_guard<mutex> l(_m);
+    _connections.erase(c);
+    close(c->fd);
+    c.reset();
+    --_writers;
+    _finished.push_back(this_thread::get_id());
+    _idle.notify_all();}
+
+// joins the connection threads that have finished; called only from run, which starts them
+void collatz_server::reap () {
+    unique_lock<mutex> l(_m);
+    vector<thread::id> f;
+    f.swap(_finished);
+    l.unlock();
+    for (const thread::id& i : f) {
+        const map<thread::id, thread>::iterator t = _threads.find(i);
+        t->second.join();
+        _threads.erase(t);}}
+
+void collatz_server::evaluate () {
+    const size_t  t = (_options.threads != 0) ? _options.threads : max<size_t>(1, thread::hardware_concurrency());
+    collatz_pool  p(t);
+    vector<entry> es;
+    vector<int>   vs;
+    const function<void (size_t)> f = [&] (size_t k) {
+        const entry& e = es[k];
+        vs[k] = 0;
+        if (e.i != 0)
+            try {
+                vs[k] = _index ? collatz_eval(*_index, e.i, e.j) : collatz_eval(_cache, e.i, e.j);}
+            catch (const overflow_error&)
+                {}};
+    while (true) {
+        unique_lock<mutex> l(_m);
+        _not_empty.wait(l, [&] () {return !_queue.empty() || _done;});
+        if (_queue.empty())
+            return;
+        const size_t n = min(_queue.size(), collatz_batch);
+        es.assign(make_move_iterator(_queue.begin()), make_move_iterator(_queue.begin() + n));
+        _queue.erase(_queue.begin(), _queue.begin() + n);
+        l.unlock();
+        _not_full.notify_all();
+        long long m = 0;
+        for (const entry& e : es)
+            m = max(m, max(e.i, e.j));
+        select_index(_cache, _index, _options, m);
+        vs.resize(n);
+        p.run(n, f);
+        // the answers of a connection go to its writer in order, a run of them at a time
+        size_t r = 0;
+        for (size_t b = 0; b != n;) {
+            connection& c = *es[b].c;
+            size_t      e = b;
+            while ((e != n) && (es[e].c == es[b].c))
+                ++e;
+            lock_guard<mutex> g(c.m);
+            for (size_t k = b; k != e; ++k) {
+                if (es[k].i == 0) {
+                    c.ended = true;
+                    continue;}
+                ++r;
+                if ((vs[k] == 0) && !c.failed) {
+                    c.failed = true;
+                    shutdown(c.fd, SHUT_RD);}
+                if (c.failed)
+                    --c.pending;
+                else
+                    c.answers.push_back(connection::answer {es[k].i, es[k].j, vs[k]});}
+            c.changed.notify_all();
+            b = e;}
+        _batches.fetch_add(1);
+        _ranges.fetch_add(r);
+        es.clear();}}
+
+void collatz_server::run () {
+    thread e(&collatz_server::evaluate, this);
+    while (true) {
+        const int fd = accept(_listen, nullptr, nullptr);
+        unique_lock<mutex> l(_m);
+        if (_stop) {
+            if (fd != -1)
+                close(fd);
+            break;}
+        if (fd == -1) {
+            if ((errno == EINTR) || (errno == ECONNABORTED))
+                continue;
+            break;}
+#ifdef SO_NOSIGPIPE
+        const int y = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &y, sizeof(y));
+#endif
+        const shared_ptr<connection> c = make_shared<connection>(fd);
+        _connections.insert(c);
+        ++_readers;
+        ++_writers;
+        l.unlock();
+        reap();
+        thread r(&collatz_server::read,  this, c);
+        thread w(&collatz_server::write, this, c);
+        const thread::id ri = r.get_id();
+        const thread::id wi = w.get_id();
+        _threads.emplace(ri, move(r));
+        _threads.emplace(wi, move(w));}
+    unique_lock<mutex> l(_m);
+    _idle.wait(l, [&] () {return _readers == 0;});
+    _done = true;
+    l.unlock();
+    _not_empty.notify_all();
+    e.join();
+    // every answer is with its writer; a writer still blocked on a client that isn't reading is cut off
+    l.lock();
+    if (!_idle.wait_for(l, server_linger, [&] () {return _writers == 0;}))
+        for (const shared_ptr<connection>& c : _connections)
+            shutdown(c->fd, SHUT_WR);
+    _idle.wait(l, [&] () {return _writers == 0;});
+    l.unlock();
+    reap();}
+
+void collatz_server::stop () {
+    lock_guard<mutex> l(_m);
+    if (_stop)
+        return;
+    _stop = true;
+    // wakes accept, and ends every read, without closing what the writers may still write to
+    shutdown(_listen, SHUT_RDWR);
+    for (const shared_ptr<connection>& c : _connections) {
+        shutdown(c->fd, SHUT_RD);
+        // a reader waiting for room checks _stop under c->m
+        lock_guard<mutex> g(c->m);
+        c->changed.notify_all();}
+    _not_full.notify_all();}
+
+// ---------------
+// collatz_connect
+// ---------------
+
+int collatz_connect (const string& path) {
+    sockaddr_un a;
+    memset(&a, 0, sizeof(a));
+    a.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(a.sun_path))
+        throw runtime_error("collatz_connect: path too long " + path);
+    copy(path.begin(), path.end(), a.sun_path);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+        throw runtime_error("collatz_connect: socket failed");
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&a), sizeof(a)) == -1) {
+        close(fd);
+        throw runtime_error("collatz_connect: can't connect to " + path);}
+    return fd;}
@@ -11,35 +11,593 @@
 // includes
 // --------
 
-#include <iostream> // istream, ostream
-#include <string>   // string
-#include <utility>  // pair
+#include <atomic>             // atomic
+#include <condition_variable> // condition_variable
+#include <cstddef>            // size_t
+#include <cstdint>            // uint16_t, uint64_t
+#include <deque>              // deque
+#include <exception>          // exception_ptr
+#include <functional>         // function
+#include <iostream>           // istream, ostream
+#include <map>                // map
+#include <memory>             // shared_ptr, unique_ptr
+#include <mutex>              // mutex
+#include <set>                // set
+#include <string>             // string
+#include <thread>             // thread
+#include <utility>            // pair
+#include <vector>             // vector
 
 using namespace std;
 
+// ---------------
+// collatz_advance
+// ---------------
+
+/**
+ * the largest value that collatz_advance steps; 3n + 1 stays below 2^63
+ */
+const uint64_t collatz_guard = ((uint64_t(1) << 63) - 2) / 3;
+
+/**
+ * steps each n[k] until it drops below floor or rises above collatz_guard
+ * the values advance in lockstep, eight at a time on AVX2, with a branchless
+ * even/odd step; a lane that finishes is masked until the next check of the
+ * lanes, then written back and refilled with the next value
+ * falls back to collatz_advance_scalar on CPUs without AVX2
+ * @param n     count values >= floor, replaced by where they stopped
+ * @param s     the number of steps taken by each value
+ * @param count the number of values
+ * @param floor a value >= 2
+ */
+void collatz_advance (uint64_t* n, uint16_t* s, size_t count, uint64_t floor);
+
+/**
+ * the same as collatz_advance, one value at a time
+ */
+void collatz_advance_scalar (uint64_t* n, uint16_t* s, size_t count, uint64_t floor);
+
+// -------------
+// collatz_cache
+// -------------
+
+/**
+ * memoized cycle lengths
+ * a dense array holds the cycle lengths of the small n, filled lazily,
+ * and a bounded, direct-mapped hash holds the large intermediate values
+ * that the 3n+1 steps reach; a colliding entry simply overwrites the old one
+ * half of the memory budget goes to each
+ * a walk steps in 128 bits, one plain step (n / 2 or 3n + 1) at a time
+ * below the dense bound (or 2^12, if that is larger), and 12 shortcut steps at a time
+ * from a table above it, and throws overflow_error if it would still overflow
+ * every entry is a relaxed atomic, so threads may share one cache;
+ * a racing fill can only store the same value twice
+ * fill computes a whole prefix of the dense array at once with collatz_advance
+ */
+class collatz_cache {
+    public:
+        using size_type  = size_t;
+        using value_type = uint16_t;
+
+        /**
+         * the default memory budget, in bytes
+         * enough for the dense array to cover [1, 2^21)
+         */
+        static const size_type default_budget = size_type(8) << 20;
+
+    private:
+        // one per thread shard, padded so that threads don't share a line
+        struct counters {
+            atomic<size_type> hits;
+            atomic<size_type> misses;
+            char              pad[64 - (2 * sizeof(atomic<size_type>))];};
+
+        static const size_type shards = 16;
+
+        vector<atomic<value_type>> _dense;
+        vector<atomic<uint64_t>>   _hash;
+        counters                   _counters[shards];
+        atomic<size_type>          _filled;
+        mutex                      _fill;
+
+        value_type lookup (uint64_t n) const;
+        void       store  (uint64_t n, value_type v);
+
+    public:
+        /**
+         * @param budget the memory budget, in bytes, for the dense array and the hash
+         */
+        explicit collatz_cache (size_type budget = default_budget);
+
+        /**
+         * @param n a positive value
+         * @return the cycle length of n
+         */
+        int cycle_length (uint64_t n);
+
+        /**
+         * makes the dense array known on [1, min(n + 1, bound()))
+         * @param n a value
+         */
+        void fill (uint64_t n);
+
+        /**
+         * @return the dense array covers [1, bound())
+         */
+        size_type bound () const {
+            return _dense.size();}
+
+        /**
+         * @return the number of cycle_length calls answered without walking
+         */
+        size_type hits () const;
+
+        /**
+         * @return the number of cycle_length calls that walked the sequence
+         */
+        size_type misses () const;};
+
+// -------------
+// collatz_index
+// -------------
+
+/**
+ * range-max index over the cycle lengths of [1, bound)
+ * the domain is cut into blocks of block values, and the blocks into spans of
+ * span blocks; a sparse table over the span maxima answers the whole spans of
+ * a query in O(1), the at most 2 * (span - 1) whole blocks around them are read
+ * from the block maxima, and the at most two partial blocks at its ends are
+ * scanned through the cache, in O(block)
+ * the block maxima are read in place, so an index over a collatz_table or a
+ * collatz_store shares its pages and adds only the sparse table
+ * building costs bound cycle lengths (mostly cache fills), unless the maxima are given,
+ * plus (bound / block / span) * log2(bound / block / span) table entries;
+ * the table takes 2 * (bound / block / span) * (log2(bound / block / span) + 1) bytes
+ * for bound = 10^6: block = 64 scans <= 128 values per query, and its maxima take ~31 KB,
+ * block = 1024 scans <= 2048, and its maxima take ~2 KB;
+ * for bound = 2^32 and block = 64, the maxima take 128 MB, the table ~9 MB
+ * queries past the bound scan their remainder through the cache
+ */
+class collatz_index {
+    public:
+        using size_type  = size_t;
+        using value_type = uint16_t;
+
+        static const size_type default_block = 64;
+        static const size_type span          = 256;
+
+    private:
+        collatz_cache&             _c;
+        size_type                  _bound;
+        size_type                  _block;
+        vector<value_type>         _own;
+        const value_type*          _maxima;
+        vector<vector<value_type>> _table;
+
+        int  scan  (uint64_t i, uint64_t j);
+        int  whole (uint64_t b, uint64_t e) const;
+        void build ();
+
+    public:
+        /**
+         * fills c with the cycle lengths of [1, bound)
+         * @param c     the cache that answers the partial blocks
+         * @param bound the end of the indexed domain, exclusive
+         * @param block the number of values per block
+         */
+        collatz_index (collatz_cache& c, size_type bound, size_type block = default_block);
+
+        /**
+         * builds only the sparse table over block maxima computed elsewhere,
+         * which it reads in place and which must outlive it, and leaves c to fill itself lazily
+         * @param c      the cache that answers the partial blocks
+         * @param maxima the (bound + block - 1) / block block maxima, as in maxima()
+         * @param bound  the end of the indexed domain, exclusive
+         * @param block  the number of values per block
+         */
+        collatz_index (collatz_cache& c, const value_type* maxima, size_type bound, size_type block);
+
+        collatz_index             (const collatz_index&) = delete;
+        collatz_index& operator = (const collatz_index&) = delete;
+
+        /**
+         * @param i the beginning of the range, inclusive
+         * @param j the end       of the range, inclusive
+         * @return the max cycle length of the range [i, j]
+         */
+        int query (uint64_t i, uint64_t j);
+
+        size_type bound () const {
+            return _bound;}
+
+        size_type block () const {
+            return _block;}
+
+        /**
+         * @return the number of blocks, (bound + block - 1) / block
+         */
+        size_type blocks () const {
+            return (_bound + _block - 1) / _block;}
+
+        /**
+         * @return the max cycle length of each block, block b covering [b * block, (b + 1) * block)
+         */
+        const value_type* maxima () const {
+            return _maxima;}
+
+        /**
+         * @return the number of bytes the index holds itself: the sparse table,
+         * and the block maxima if it computed them
+         */
+        size_type memory () const;};
+
+// -------------
+// collatz_table
+// -------------
+
+/**
+ * the block maxima of [1, collatz_table_bound), computed at build time
+ * by GenCollatz into CollatzTable.c++ (make TABLE=1) and linked in as read-only data;
+ * the index reads it in place, adding only its table over spans, so a process starts
+ * with its index ready and shares the maxima with every other through the page cache
+ * defined only in that build, where RunCollatz also defines COLLATZ_TABLE
+ */
+extern const uint16_t collatz_table[];
+extern const size_t   collatz_table_bound;
+extern const size_t   collatz_table_block;
+
+// -------------
+// collatz_store
+// -------------
+
+/**
+ * block maxima that persist in a file across runs and grow over time
+ * the file is a header (magic, version, block, bound, and an FNV-1a checksum
+ * of the maxima) followed by the maxima of the blocks of [0, bound); it is
+ * mmapped read-only and shared, so processes on one host share its pages
+ * extend appends blocks under an exclusive flock and writes the maxima before
+ * the header, so concurrent writers take turns and a reader, which maps under
+ * a shared flock, never sees a header that covers maxima not yet written
+ * an existing file keeps its own block size
+ * a file that can't be opened, or fails its checks, throws runtime_error
+ */
+class collatz_store {
+    private:
+        int             _fd;
+        void*           _map;
+        size_t          _size;
+        size_t          _block;
+        size_t          _bound;
+        uint64_t        _checksum;
+        const uint16_t* _maxima;
+
+        void map ();
+
+    public:
+        /**
+         * opens path, creating an empty store if there is none
+         * @param path  the file
+         * @param block the number of values per block of a new file
+         */
+        explicit collatz_store (const string& path, size_t block = collatz_index::default_block);
+
+        collatz_store             (const collatz_store&) = delete;
+        collatz_store& operator = (const collatz_store&) = delete;
+
+        ~collatz_store ();
+
+        /**
+         * extend never grows a store past limit
+         */
+        static const uint64_t limit = uint64_t(1) << 32;
+
+        /**
+         * @return the maxima cover [1, bound()), a multiple of block()
+         */
+        size_t bound () const {
+            return _bound;}
+
+        size_t block () const {
+            return _block;}
+
+        /**
+         * @return the bound() / block() block maxima, as in collatz_index::maxima
+         */
+        const uint16_t* maxima () const {
+            return _maxima;}
+
+        /**
+         * grows the file to cover at least [1, bound), computing the new blocks through c,
+         * and remaps it; also picks up what other processes appended
+         * @param c     a collatz_cache
+         * @param bound the end of the domain to cover, exclusive
+         */
+        void extend (collatz_cache& c, uint64_t bound);};
+
+// ------------
+// collatz_mode
+// ------------
+
+enum collatz_mode {
+    collatz_scan,     // scan each range through a collatz_cache
+    collatz_indexed}; // answer each range from a collatz_index
+
+// ---------------
+// collatz_options
+// ---------------
+
+/**
+ * how collatz_solve evaluates its ranges
+ * bound and block configure the collatz_index of the collatz_indexed mode;
+ * if table is set, it holds the block maxima of that index, as in collatz_table
+ * if store is set, the mode is collatz_indexed, the index reads the store's maxima in place,
+ * and a range that ends within twice the store's bound (or 2^20) extends the store to cover it,
+ * up to collatz_store::limit; a range further out is scanned past the store's end through the cache
+ * threads > 1 reads the queries in batches and spreads each batch over a
+ * work-stealing pool of that many threads, one cache shared by all of them;
+ * the output is still in input order
+ * threads = 0 means one per hardware thread
+ * if cache is set, collatz_solve evaluates through it instead of a cache of its own,
+ * so its hits and misses can be read afterwards, and what it learned carries over to the next call
+ */
+struct collatz_options {
+    collatz_mode    mode    = collatz_scan;
+    size_t          bound   = 1000000;
+    size_t          block   = collatz_index::default_block;
+    const uint16_t* table   = nullptr;
+    collatz_store*  store   = nullptr;
+    size_t          threads = 1;
+    collatz_cache*  cache   = nullptr;};
+
+// --------------
+// collatz_reader
+// --------------
+
+/**
+ * the fast input path: reads whole buffers and parses the ints by hand
+ * a regular file is mmapped; anything else, a pipe or a tty, is read
+ * in large chunks, and a token longer than a chunk grows the buffer
+ */
+class collatz_reader {
+    public:
+        static const size_t chunk = size_t(1) << 20;
+
+    private:
+        int          _fd;
+        void*        _map;
+        size_t       _size;
+        vector<char> _buffer;
+        const char*  _p;
+        const char*  _e;
+        bool         _eof;
+
+        bool refill ();
+
+    public:
+        /**
+         * @param fd an open file descriptor, not closed by the reader
+         */
+        explicit collatz_reader (int fd);
+
+        /**
+         * reads from the characters [b, e), which must outlive the reader
+         */
+        collatz_reader (const char* b, const char* e);
+
+        collatz_reader             (const collatz_reader&) = delete;
+        collatz_reader& operator = (const collatz_reader&) = delete;
+
+        ~collatz_reader ();
+
+        /**
+         * T is int or long long
+         * @param n an int
+         * @return true if an int was read into n, otherwise false
+         */
+        template <typename T>
+        bool read (T& n);};
+
+// --------------
+// collatz_writer
+// --------------
+
+/**
+ * the fast output path: formats into one buffer by hand and writes it
+ * to a file descriptor in chunks of at least collatz_reader::chunk bytes
+ * the buffer is also written by flush and by the destructor
+ * a write that fails throws runtime_error from flush, and drops the buffer;
+ * the destructor can't throw, so flush before it to see the error
+ * a socket is written without raising SIGPIPE, so a peer that goes away is an error, not a signal
+ */
+class collatz_writer {
+    private:
+        int          _fd;
+        bool         _socket;
+        vector<char> _buffer;
+
+    public:
+        /**
+         * @param fd an open file descriptor, not closed by the writer
+         */
+        explicit collatz_writer (int fd);
+
+        collatz_writer             (const collatz_writer&) = delete;
+        collatz_writer& operator = (const collatz_writer&) = delete;
+
+        ~collatz_writer ();
+
+        /**
+         * T is int or long long
+         * @param n an int
+         * @param c the character that follows n
+         */
+        template <typename T>
+        void write (T n, char c);
+
+        void flush ();};
+
+// -------------
+// collatz_stats
+// -------------
+
+/**
+ * the hot path's counters: the calls to collatz_read, collatz_eval and collatz_print,
+ * their time and a histogram of their latencies, and the cache's hits, misses and steps walked
+ * each thread counts into its own collatz_stats, merged by collatz_stats_collect
+ * compiled in only with -DCOLLATZ_STATS; otherwise nothing is counted and every collatz_stats is zero
+ */
+enum collatz_phase {
+    collatz_phase_read,
+    collatz_phase_eval,
+    collatz_phase_print,
+    collatz_phases};
+
+struct collatz_stats {
+    static const int buckets = 40; // bucket b counts latencies in [2^b, 2^(b + 1)) ns
+
+    uint64_t calls     [collatz_phases]          = {};
+    uint64_t ns        [collatz_phases]          = {};
+    uint64_t histogram [collatz_phases][buckets] = {};
+    uint64_t hits                                = 0;
+    uint64_t misses                              = 0;
+    uint64_t steps                               = 0;
+
+    collatz_stats& operator += (const collatz_stats& rhs);};
+
+/**
+ * @return true if Collatz.c++ was compiled with -DCOLLATZ_STATS
+ */
+bool collatz_stats_enabled ();
+
+/**
+ * best called when the threads being counted are idle, as at the end of a run
+ * @return the sum of the stats of every thread, live or finished
+ */
+collatz_stats collatz_stats_collect ();
+
+/**
+ * zeroes the stats of every thread
+ */
+void collatz_stats_reset ();
+
+/**
+ * writes s as lines of "name value", or "name value value ..." for a histogram
+ * @param w an ostream
+ * @param s a collatz_stats
+ */
+void collatz_stats_dump (ostream& w, const collatz_stats& s);
+
+// ------------
+// collatz_pool
+// ------------
+
+/**
+ * a fixed set of threads that runs f(0) ... f(n - 1) with work stealing
+ * each worker owns a contiguous slice of [0, n) and takes from its front;
+ * a worker whose slice is empty steals the back half of another's
+ * the calling thread is worker 0
+ */
+class collatz_pool {
+    private:
+        struct slice {
+            mutex  m;
+            size_t b;
+            size_t e;};
+
+        vector<thread>                 _threads;
+        vector<unique_ptr<slice>>      _slices;
+        mutex                          _m;
+        condition_variable             _go;
+        condition_variable             _done;
+        const function<void (size_t)>* _f;
+        size_t                         _generation;
+        size_t                         _busy;
+        bool                           _stop;
+        exception_ptr                  _error;
+
+        bool take  (size_t w, size_t& k);
+        bool split (size_t v, size_t& b, size_t& e);
+        bool steal (size_t w);
+        void work  (size_t w);
+        void loop  (size_t w);
+
+    public:
+        /**
+         * @param n the number of workers, the calling thread included
+         */
+        explicit collatz_pool (size_t n);
+
+        collatz_pool             (const collatz_pool&) = delete;
+        collatz_pool& operator = (const collatz_pool&) = delete;
+
+        ~collatz_pool ();
+
+        /**
+         * returns when every f(k) has returned or thrown
+         * if any threw, the worker that caught it stops taking work, the others finish theirs,
+         * and run rethrows the first exception on the calling thread
+         * @param n the number of calls
+         * @param f called once for each k in [0, n)
+         */
+        void run (size_t n, const function<void (size_t)>& f);};
+
 // ------------
 // collatz_read
 // ------------
 
+// every function below is a template on the integer width, T, which is int or long long;
+// the ranges themselves may reach 2^63 - 1, and the walks 2^128
+
 /**
  * read two ints from r into i an j
  * @param r an istream
  * @param i an int
- * @param j an int
+ * @param j an int, 0 if i is the last int in r
  * @return true if the read is successful, otherwise false
  */
-bool collatz_read (istream& r, int& i, int& j);
+template <typename T>
+bool collatz_read (istream& r, T& i, T& j);
+
+/**
+ * read two ints from r into i an j
+ * @param r a collatz_reader
+ * @param i an int
+ * @param j an int, 0 if i is the last int in r
+ * @return true if the read is successful, otherwise false
+ */
+template <typename T>
+bool collatz_read (collatz_reader& r, T& i, T& j);
 
 // ------------
 // collatz_eval
 // ------------
 
 /**
+ * @param c a collatz_cache
+ * @param i the beginning of the range, inclusive
+ * @param j the end       of the range, inclusive
+ * @return the max cycle length of the range [i, j]
+ */
+template <typename T>
+int collatz_eval (collatz_cache& c, T i, T j);
+
+/**
+ * uses a cache shared by every call
+ * @param i the beginning of the range, inclusive
+ * @param j the end       of the range, inclusive
+ * @return the max cycle length of the range [i, j]
+ */
+template <typename T>
+int collatz_eval (T i, T j);
+
+/**
+ * @param x a collatz_index
  * @param i the beginning of the range, inclusive
  * @param j the end       of the range, inclusive
- * @return the max cycle length of the range [i, j)
+ * @return the max cycle length of the range [i, j]
  */
-int collatz_eval (int i, int j);
+template <typename T>
+int collatz_eval (collatz_index& x, T i, T j);
 
 // -------------
 // collatz_print
@@ -52,16 +610,160 @@ int collatz_eval (int i, int j);
  * @param j the end       of the range, inclusive
  * @param v the max cycle length
  */
-void collatz_print (ostream& w, int i, int j, int v);
+template <typename T>
+void collatz_print (ostream& w, T i, T j, int v);
+
+/**
+ * print three ints to w, exactly as the ostream version does
+ * @param w a collatz_writer
+ * @param i the beginning of the range, inclusive
+ * @param j the end       of the range, inclusive
+ * @param v the max cycle length
+ */
+template <typename T>
+void collatz_print (collatz_writer& w, T i, T j, int v);
 
 // -------------
 // collatz_solve
 // -------------
 
+/**
+ * @param r an istream
+ * @param w an ostream
+ * @param o the evaluation mode
+ */
+template <typename T = int>
+void collatz_solve (istream& r, ostream& w, const collatz_options& o);
+
 /**
  * @param r an istream
  * @param w an ostream
  */
+template <typename T = int>
 void collatz_solve (istream& r, ostream& w);
 
+/**
+ * the fast path, through a collatz_reader and a collatz_writer
+ * @param r a readable file descriptor
+ * @param w a writable file descriptor
+ * @param o the evaluation mode
+ */
+template <typename T = int>
+void collatz_solve (int r, int w, const collatz_options& o);
+
+// --------------
+// collatz_server
+// --------------
+
+/**
+ * a resident collatz_solve: answers query streams over a Unix domain socket
+ * and keeps one collatz_cache, and the index of its options, warm across connections
+ * each connection sends ranges and gets back lines, as collatz_solve<long long> would,
+ * in the order of its ranges; it ends when the client shuts down its side
+ * the ranges of every connection go through one queue and are evaluated together,
+ * in batches of up to 4096, on options.threads threads
+ * the queue holds at most depth ranges; a full queue stops the reading of every
+ * connection, which pushes back through the sockets to the clients
+ * each connection has a thread that reads it and one that writes its answers, and at most
+ * depth ranges read but not yet written, so a client that doesn't read its answers stops
+ * only its own reading and writing, and never the evaluation of the others
+ * a range that isn't two positive ints ends its connection, and so does one whose walk overflows,
+ * after the answers before it
+ */
+class collatz_server {
+    public:
+        static const size_t default_depth = 16384;
+
+    private:
+        struct connection;
+
+        // a range of c, or the end of c if i is 0
+        struct entry {
+            shared_ptr<connection> c;
+            long long              i;
+            long long              j;};
+
+        string                      _path;
+        collatz_options             _options;
+        size_t                      _depth;
+        int                         _listen;
+        collatz_cache               _cache;
+        unique_ptr<collatz_index>   _index;
+        mutex                       _m;
+        condition_variable          _not_empty;
+        condition_variable          _not_full;
+        condition_variable          _idle;
+        deque<entry>                _queue;
+        set<shared_ptr<connection>> _connections;
+        map<thread::id, thread>     _threads;
+        vector<thread::id>          _finished;
+        size_t                      _readers;
+        size_t                      _writers;
+        atomic<bool>                _stop;
+        bool                        _done;
+        atomic<size_t>              _batches;
+        atomic<size_t>              _ranges;
+
+        void push     (entry e);
+        void read     (shared_ptr<connection> c);
+        void write    (shared_ptr<connection> c);
+        void evaluate ();
+        void reap     ();
+
+    public:
+        /**
+         * binds and listens on path, replacing a socket, but nothing else, already there
+         * a path that can't be bound throws runtime_error
+         * @param path    the socket
+         * @param o       how the ranges are evaluated
+         * @param depth   the most ranges queued at once
+         */
+        collatz_server (const string& path, const collatz_options& o = collatz_options(), size_t depth = default_depth);
+
+        collatz_server             (const collatz_server&) = delete;
+        collatz_server& operator = (const collatz_server&) = delete;
+
+        /**
+         * joins the connection threads, and closes and removes the socket
+         */
+        ~collatz_server ();
+
+        /**
+         * accepts and answers connections until stop, then answers what every
+         * connection has already sent, and returns
+         * a client that isn't reading then has a second to take its answers before they're dropped
+         * a client that goes away only loses its own answers; no SIGPIPE is raised
+         * every connection thread has been joined by the time run returns
+         */
+        void run ();
+
+        /**
+         * makes run stop accepting and stop reading, and wakes every reader waiting for room;
+         * safe from any thread, but not from a signal handler
+         */
+        void stop ();
+
+        /**
+         * @return the number of batches evaluated so far
+         */
+        size_t batches () const {
+            return _batches.load();}
+
+        /**
+         * @return the number of ranges evaluated so far
+         */
+        size_t ranges () const {
+            return _ranges.load();}};
+
+// ---------------
+// collatz_connect
+// ---------------
+
+/**
+ * a path with no collatz_server listening throws runtime_error
+ * @param path the socket of a collatz_server
+ * @return a file descriptor connected to it, to be closed by the caller
+ */
+int collatz_connect (const string& path);
+
 #endif // Collatz_h
@@ -0,0 +1,54 @@
+// -------------------------------
+// projects/collatz/GenCollatz.c++
+// Copyright (C) 2016
+// Glenn P. Downing
+// -------------------------------
+
+// --------
+// includes
+// --------
+
+#include <cstdlib>  // strtoul
+#include <iostream> // cerr, cout, endl
+
+#include "Collatz.h"
+
+// ----
+// main
+// ----
+
+/**
+ * writes CollatzTable.c++, the block maxima of [1, bound), to cout
+ * bound must be positive
+ * usage: GenCollatz bound block
+ */
+int main (int argc, char* argv[]) {
+    using namespace std;
+    if (argc != 3) {
+        cerr << "usage: GenCollatz bound block" << endl;
+        return 1;}
+    const size_t  bound = strtoul(argv[1], nullptr, 10);
+    const size_t  block = strtoul(argv[2], nullptr, 10);
+    // a bound of 0 has no blocks, and C++ has no arrays of 0 elements
+    if (bound == 0) {
+        cerr << "GenCollatz: bound must be positive" << endl;
+        return 1;}
+    collatz_cache c;
+    collatz_index x(c, bound, block);
+    const collatz_index::value_type* m = x.maxima();
+    cout << "// generated by GenCollatz " << x.bound() << " " << x.block() << ", do not edit\n"
+         << "\n"
+         << "#include \"Collatz.h\"\n"
+         << "\n"
+         << "const size_t   collatz_table_bound = " << x.bound() << ";\n"
+         << "const size_t   collatz_table_block = " << x.block() << ";\n"
+         << "const uint16_t collatz_table[]     = {";
+    for (size_t b = 0; b != x.blocks(); ++b)
+        cout << (((b % 16) == 0) ? "\n    " : " ") << m[b] << ",";
+    cout << "};\n";
+    return 0;}
+
+/*
+% g++ -pedantic -std=c++11 -Wall -O2 Collatz.c++ GenCollatz.c++ -o GenCollatz -pthread
+% ./GenCollatz 1000000 64 > CollatzTable.c++
+*/
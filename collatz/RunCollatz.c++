@@ -8,21 +8,147 @@
 // includes
 // --------
 
-#include <iostream> // cin, cout
+#include <csignal>   // sigaddset, sigemptyset, sigset_t, sigwait, SIGINT, SIGTERM
+#include <cstddef>   // size_t
+#include <iostream>  // cerr, cin, cout, endl
+#include <memory>    // unique_ptr
+#include <stdexcept> // out_of_range, runtime_error
+#include <string>    // stoul, string
+#include <thread>    // thread
+
+#include <pthread.h> // pthread_kill, pthread_sigmask
 
 #include "Collatz.h"
 
+// ------
+// number
+// ------
+
+/**
+ * @param s a command-line argument
+ * @param n the number in s
+ * @return true if s is a whole decimal number that fits in n; stoul alone would take "-1" and "64x"
+ */
+bool number (const std::string& s, std::size_t& n) {
+    if (s.empty() || (s.find_first_not_of("0123456789") != std::string::npos))
+        return false;
+    try {
+        n = std::stoul(s);}
+    catch (const std::out_of_range&) {
+        return false;}
+    return true;}
+
 // ----
 // main
 // ----
 
-int main () {
+int main (int argc, char* argv[]) {
     using namespace std;
-    collatz_solve(cin, cout);
+    collatz_options o;
+    bool            f = false;
+    bool            l = false;
+    bool            d = false;
+    string          p;
+    string          q;
+#ifdef COLLATZ_TABLE
+    o.mode  = collatz_indexed;
+    o.table = collatz_table;
+    o.bound = collatz_table_bound;
+    o.block = collatz_table_block;
+#endif
+    for (int a = 1; a != argc; ++a) {
+        const string s = argv[a];
+        if (s == "--index")
+            o.mode = collatz_indexed;
+        else if (s == "--scan")
+            o.mode = collatz_scan;
+        else if ((s == "--bound") && ((a + 1) != argc) && number(argv[a + 1], o.bound)) {
+            ++a;
+            o.table = nullptr;}
+        else if ((s == "--block") && ((a + 1) != argc) && number(argv[a + 1], o.block)) {
+            ++a;
+            o.table = nullptr;}
+        else if ((s == "--threads") && ((a + 1) != argc) && number(argv[a + 1], o.threads))
+            ++a;
+        else if (s == "--fast")
+            f = true;
+        else if (s == "--wide")
+            l = true;
+        else if (s == "--stats")
+            d = true;
+        else if ((s == "--store") && ((a + 1) != argc))
+            p = argv[++a];
+        else if ((s == "--serve") && ((a + 1) != argc))
+            q = argv[++a];
+        else {
+            cerr << "usage: RunCollatz [--scan | --index [--bound n] [--block n] | --store file] [--threads n] [--fast] [--wide] [--serve path] [--stats]" << endl;
+            return 1;}}
+    try {
+        unique_ptr<collatz_store> t;
+        if (!p.empty()) {
+            t.reset(new collatz_store(p, o.block));
+            o.store = t.get();}
+        if (!q.empty()) {
+            // SIGINT and SIGTERM stop the server gracefully, from a thread of their own
+            sigset_t m;
+            sigemptyset(&m);
+            sigaddset(&m, SIGINT);
+            sigaddset(&m, SIGTERM);
+            pthread_sigmask(SIG_BLOCK, &m, nullptr);
+            collatz_server v(q, o);
+            thread         h([&] () {
+                int g;
+                sigwait(&m, &g);
+                v.stop();});
+            // run may also return, or throw, without a signal; one more wakes the waiter either way
+            const auto j = [&] () {
+                pthread_kill(h.native_handle(), SIGTERM);
+                h.join();};
+            try {
+                v.run();}
+            catch (...) {
+                j();
+                throw;}
+            j();}
+        else if (f && l)
+            collatz_solve<long long>(0, 1, o);
+        else if (f)
+            collatz_solve(0, 1, o);
+        else if (l)
+            collatz_solve<long long>(cin, cout, o);
+        else
+            collatz_solve(cin, cout, o);
+        if (d)
+            collatz_stats_dump(cerr, collatz_stats_collect());}
+    catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;}
     return 0;}
 
 /*
 % g++-4.8 -pedantic -std=c++11 -Wall -fprofile-arcs -ftest-coverage Collatz.c++ RunCollatz.c++ -o RunCollatz
 % ./RunCollatz < RunCollatz.in > RunCollatz.tmp
 % diff RunCollatz.tmp RunCollatz.out
+% ./RunCollatz --index < RunCollatz.in > RunCollatz.tmp
+% diff RunCollatz.tmp RunCollatz.out
+% ./RunCollatz --threads 4 < RunCollatz.in > RunCollatz.tmp
+% diff RunCollatz.tmp RunCollatz.out
+% ./RunCollatz --fast < RunCollatz.in > RunCollatz.tmp
+% diff RunCollatz.tmp RunCollatz.out
+% ./RunCollatz --store RunCollatz.db < RunCollatz.in > RunCollatz.tmp
+% diff RunCollatz.tmp RunCollatz.out
+% ./RunCollatz --wide < RunCollatz.in > RunCollatz.tmp
+% diff RunCollatz.tmp RunCollatz.out
+% ./RunCollatz --serve RunCollatz.sock &
+% ./ClientCollatz RunCollatz.sock < RunCollatz.in > RunCollatz.tmp
+% diff RunCollatz.tmp RunCollatz.out
+% kill %1
+
+% make STATS=1 RunCollatz
+% ./RunCollatz --stats < RunCollatz.in > RunCollatz.tmp 2> RunCollatz.stats
+% diff RunCollatz.tmp RunCollatz.out
+
+% make TABLE=1 RunCollatz
+% ./RunCollatz < RunCollatz.in > RunCollatz.tmp
+% diff RunCollatz.tmp RunCollatz.out
 */
@@ -10,10 +10,24 @@
 // includes
 // --------
 
+#include <algorithm> // equal
+#include <atomic>    // atomic
+#include <chrono>    // milliseconds
+#include <cstdio>   // fileno, fclose, tmpfile
+#include <cstdlib>  // mkstemp
+#include <cstring>  // strlen
+#include <functional> // function
 #include <iostream> // cout, endl
 #include <sstream>  // istringtstream, ostringstream
+#include <stdexcept> // overflow_error, runtime_error
 #include <string>   // string
+#include <thread>   // sleep_for, thread
 #include <utility>  // pair
+#include <vector>   // vector
+
+#include <fcntl.h>      // open, O_RDONLY, O_WRONLY
+#include <sys/socket.h> // send, shutdown, MSG_NOSIGNAL, SHUT_WR
+#include <unistd.h>     // close, getpid, lseek, pipe, pwrite, read, unlink, write
 
 #include "gtest/gtest.h"
 
@@ -34,25 +48,415 @@ TEST(CollatzFixture, read) {
     ASSERT_EQ( 1, i);
     ASSERT_EQ(10, j);}
 
+TEST(CollatzFixture, read_fast_1) {
+    const char*    s = " 1 10\n\t100\r\n200 ";
+    collatz_reader r(s, s + strlen(s));
+    int            i;
+    int            j;
+    ASSERT_TRUE(collatz_read(r, i, j));
+    ASSERT_EQ( 1, i);
+    ASSERT_EQ(10, j);
+    ASSERT_TRUE(collatz_read(r, i, j));
+    ASSERT_EQ(100, i);
+    ASSERT_EQ(200, j);
+    ASSERT_FALSE(collatz_read(r, i, j));}
+
+TEST(CollatzFixture, read_fast_2) {
+    const char*    s = "2147483647 -2147483648 2147483648";
+    collatz_reader r(s, s + strlen(s));
+    int            n;
+    ASSERT_TRUE(r.read(n));
+    ASSERT_EQ(2147483647, n);
+    ASSERT_TRUE(r.read(n));
+    ASSERT_EQ(-2147483647 - 1, n);
+    ASSERT_FALSE(r.read(n));}
+
+TEST(CollatzFixture, read_fast_3) {
+    FILE* f = tmpfile();
+    fputs("1 10\n100 200\n", f);
+    fflush(f);
+    lseek(fileno(f), 0, SEEK_SET);
+    collatz_reader r(fileno(f));
+    int            i;
+    int            j;
+    ASSERT_TRUE(collatz_read(r, i, j));
+    ASSERT_TRUE(collatz_read(r, i, j));
+    ASSERT_EQ(100, i);
+    ASSERT_EQ(200, j);
+    ASSERT_FALSE(collatz_read(r, i, j));
+    fclose(f);}
+
+TEST(CollatzFixture, read_fast_4) {
+    int p[2];
+    ASSERT_EQ(0, pipe(p));
+    ASSERT_EQ(9, write(p[1], "1 10\n100 ", 9));
+    ASSERT_EQ(4, write(p[1], "200\n",      4));
+    close(p[1]);
+    collatz_reader r(p[0]);
+    int            i;
+    int            j;
+    ASSERT_TRUE(collatz_read(r, i, j));
+    ASSERT_TRUE(collatz_read(r, i, j));
+    ASSERT_EQ(100, i);
+    ASSERT_EQ(200, j);
+    ASSERT_FALSE(collatz_read(r, i, j));
+    close(p[0]);}
+
+TEST(CollatzFixture, read_fast_5) {
+    // a token longer than the buffer is read whole
+    int p[2];
+    ASSERT_EQ(0, pipe(p));
+    const string s = string(collatz_reader::chunk + 100, '0') + "7 9\n";
+    thread       t([&] () {
+        size_t k = 0;
+        while (k != s.size()) {
+            const ssize_t n = write(p[1], s.data() + k, s.size() - k);
+            if (n <= 0)
+                break;
+            k += n;}
+        close(p[1]);});
+    collatz_reader r(p[0]);
+    int            i;
+    int            j;
+    ASSERT_TRUE(collatz_read(r, i, j));
+    ASSERT_EQ(7, i);
+    ASSERT_EQ(9, j);
+    ASSERT_FALSE(collatz_read(r, i, j));
+    t.join();
+    close(p[0]);}
+
+TEST(CollatzFixture, read_wide_1) {
+    istringstream r("1000000000000 1000000000999\n");
+    long long     i;
+    long long     j;
+    ASSERT_TRUE(collatz_read(r, i, j));
+    ASSERT_EQ(1000000000000LL, i);
+    ASSERT_EQ(1000000000999LL, j);}
+
+TEST(CollatzFixture, read_wide_2) {
+    const char*    s = "9223372036854775807 9223372036854775808";
+    collatz_reader r(s, s + strlen(s));
+    long long      n;
+    ASSERT_TRUE(r.read(n));
+    ASSERT_EQ(9223372036854775807LL, n);
+    ASSERT_FALSE(r.read(n));}
+
+TEST(CollatzFixture, read_fast_6) {
+    // a line with one number: both reads leave j 0
+    const char*    s = "5\n";
+    collatz_reader r(s, s + strlen(s));
+    istringstream  t(s);
+    int            i = 1;
+    int            j = 1;
+    ASSERT_TRUE(collatz_read(r, i, j));
+    ASSERT_EQ(5, i);
+    ASSERT_EQ(0, j);
+    i = 1;
+    j = 1;
+    ASSERT_TRUE(collatz_read(t, i, j));
+    ASSERT_EQ(5, i);
+    ASSERT_EQ(0, j);}
+
 // ----
 // eval
 // ----
 
 TEST(CollatzFixture, eval_1) {
     const int v = collatz_eval(1, 10);
-    ASSERT_EQ(1, v);}
+    ASSERT_EQ(20, v);}
 
 TEST(CollatzFixture, eval_2) {
     const int v = collatz_eval(100, 200);
-    ASSERT_EQ(1, v);}
+    ASSERT_EQ(125, v);}
 
 TEST(CollatzFixture, eval_3) {
     const int v = collatz_eval(201, 210);
-    ASSERT_EQ(1, v);}
+    ASSERT_EQ(89, v);}
 
 TEST(CollatzFixture, eval_4) {
     const int v = collatz_eval(900, 1000);
-    ASSERT_EQ(1, v);}
+    ASSERT_EQ(174, v);}
+
+TEST(CollatzFixture, eval_5) {
+    const int v = collatz_eval(10, 1);
+    ASSERT_EQ(20, v);}
+
+TEST(CollatzFixture, eval_6) {
+    const int v = collatz_eval(1, 999999);
+    ASSERT_EQ(525, v);}
+
+// -------
+// advance
+// -------
+
+TEST(CollatzFixture, advance_1) {
+    uint64_t n[] = {3, 27, 2, 9};
+    uint16_t s[4];
+    collatz_advance(n, s, 4, 2);
+    for (int k = 0; k != 4; ++k)
+        ASSERT_EQ(1, n[k]);
+    ASSERT_EQ(  7, s[0]);
+    ASSERT_EQ(111, s[1]);
+    ASSERT_EQ(  1, s[2]);
+    ASSERT_EQ( 19, s[3]);}
+
+TEST(CollatzFixture, advance_2) {
+    vector<uint64_t> n1;
+    for (uint64_t k = 1000; k != 3001; ++k)
+        n1.push_back(k);
+    n1.push_back(collatz_guard + 1);
+    vector<uint64_t> n2 = n1;
+    vector<uint16_t> s1(n1.size());
+    vector<uint16_t> s2(n2.size());
+    collatz_advance       (n1.data(), s1.data(), n1.size(), 1000);
+    collatz_advance_scalar(n2.data(), s2.data(), n2.size(), 1000);
+    ASSERT_EQ(n2, n1);
+    ASSERT_EQ(s2, s1);
+    ASSERT_EQ(collatz_guard + 1, n1.back());
+    ASSERT_EQ(0, s1.back());}
+
+TEST(CollatzFixture, eval_wide_1) {
+    const int v = collatz_eval(1000000000000LL, 1000000000999LL);
+    ASSERT_EQ(509, v);}
+
+TEST(CollatzFixture, eval_wide_2) {
+    const long long n = 1LL << 40;
+    const int       v = collatz_eval(n + 99, n);
+    ASSERT_EQ(597, v);}
+
+TEST(CollatzFixture, eval_wide_3) {
+    collatz_cache c;
+    collatz_index x(c, 1000, 16);
+    ASSERT_EQ(174, collatz_eval(x, 900LL, 1000LL));
+    ASSERT_EQ(509, collatz_eval(x, 1000000000000LL, 1000000000999LL));}
+
+// -----
+// cache
+// -----
+
+TEST(CollatzFixture, cache_1) {
+    collatz_cache c;
+    ASSERT_EQ(1, c.cycle_length(1));
+    ASSERT_EQ(8, c.cycle_length(3));
+    ASSERT_EQ(1, c.hits());
+    ASSERT_EQ(1, c.misses());}
+
+TEST(CollatzFixture, cache_2) {
+    collatz_cache c;
+    ASSERT_EQ(112, c.cycle_length(27));
+    ASSERT_EQ(111, c.cycle_length(82));
+    ASSERT_EQ(112, c.cycle_length(27));
+    ASSERT_EQ(2, c.hits());
+    ASSERT_EQ(1, c.misses());}
+
+TEST(CollatzFixture, cache_3) {
+    collatz_cache c(64);
+    ASSERT_EQ(16, c.bound());
+    ASSERT_EQ(112, c.cycle_length(27));
+    ASSERT_EQ(112, c.cycle_length(27));
+    ASSERT_EQ(1, c.hits());}
+
+TEST(CollatzFixture, cache_4) {
+    collatz_cache c(8);
+    ASSERT_EQ(2, c.bound());
+    ASSERT_EQ(  8, c.cycle_length(3));
+    ASSERT_EQ(112, c.cycle_length(27));
+    ASSERT_EQ(0, c.hits());
+    ASSERT_EQ(2, c.misses());}
+
+TEST(CollatzFixture, cache_5) {
+    collatz_cache c;
+    ASSERT_EQ(174, collatz_eval(c, 900, 1000));
+    const size_t m = c.misses();
+    ASSERT_EQ(174, collatz_eval(c, 900, 1000));
+    ASSERT_EQ(m, c.misses());}
+
+TEST(CollatzFixture, cache_6) {
+    collatz_cache  c;
+    vector<thread> t;
+    for (int k = 0; k != 4; ++k)
+        t.push_back(thread([&c] () {
+            for (int n = 1; n != 10000; ++n)
+                c.cycle_length(n);}));
+    for (thread& u : t)
+        u.join();
+    ASSERT_EQ(4 * 9999, c.hits() + c.misses());
+    ASSERT_EQ(262, c.cycle_length(6171));}
+
+TEST(CollatzFixture, cache_7) {
+    collatz_cache c1;
+    collatz_cache c2;
+    c1.fill(10000);
+    ASSERT_EQ(0, c1.misses());
+    for (int n = 1; n <= 10000; ++n)
+        ASSERT_EQ(c2.cycle_length(n), c1.cycle_length(n));
+    ASSERT_EQ(10000, c1.hits());}
+
+TEST(CollatzFixture, cache_8) {
+    collatz_cache c(64);
+    c.fill(1000);
+    ASSERT_EQ(20, c.cycle_length(9));
+    ASSERT_EQ(112, c.cycle_length(27));}
+
+TEST(CollatzFixture, cache_9) {
+    collatz_cache c;
+    ASSERT_EQ(  41, c.cycle_length(1ULL << 40));
+    ASSERT_EQ( 950, c.cycle_length(63728127));
+    ASSERT_EQ(1133, c.cycle_length(9780657630ULL));
+    ASSERT_EQ( 864, c.cycle_length(~0ULL));
+    ASSERT_EQ( 147, c.cycle_length(1000000000000ULL));}
+
+TEST(CollatzFixture, cache_10) {
+    collatz_cache c(64);
+    ASSERT_EQ( 950, c.cycle_length(63728127));
+    ASSERT_EQ(1133, c.cycle_length(9780657630ULL));
+    ASSERT_EQ( 864, c.cycle_length(~0ULL));}
+
+// -----
+// index
+// -----
+
+TEST(CollatzFixture, index_1) {
+    collatz_cache c;
+    collatz_index x(c, 1000, 16);
+    ASSERT_EQ( 20, x.query(  1,   10));
+    ASSERT_EQ(125, x.query(100,  200));
+    ASSERT_EQ( 89, x.query(201,  210));
+    ASSERT_EQ(174, x.query(900, 1000));}
+
+TEST(CollatzFixture, index_2) {
+    collatz_cache c;
+    collatz_index x(c, 100, 8);
+    for (int i = 1; i < 130; i += 7)
+        for (int j = i; j < 130; j += 5)
+            ASSERT_EQ(collatz_eval(c, i, j), x.query(i, j));}
+
+TEST(CollatzFixture, index_3) {
+    collatz_cache c;
+    collatz_index x(c, 100, 1);
+    ASSERT_EQ(100, x.bound());
+    ASSERT_EQ(  1, x.block());
+    ASSERT_EQ(119, x.query(1, 99));
+    ASSERT_EQ(119, collatz_eval(x, 99, 1));}
+
+TEST(CollatzFixture, index_4) {
+    collatz_cache c;
+    collatz_index x(c, 1024, 64);
+    ASSERT_EQ(2 * 16, x.memory());}
+
+TEST(CollatzFixture, index_5) {
+    collatz_cache c1;
+    collatz_cache c2;
+    collatz_index x(c1, 1000, 16);
+    collatz_index y(c2, x.maxima(), x.bound(), x.block());
+    ASSERT_EQ(x.maxima(), y.maxima());
+    ASSERT_EQ(0, y.memory());
+    ASSERT_EQ(0, c2.hits() + c2.misses());
+    ASSERT_EQ(179, y.query(1, 999));
+    ASSERT_EQ(174, y.query(900, 1000));
+    ASSERT_LT(c2.misses(), 50);}
+
+TEST(CollatzFixture, index_6) {
+    // a bound of 0 or 1 indexes nothing, and every query scans
+    collatz_cache c;
+    collatz_index x(c, 0, 4);
+    collatz_index y(c, 1, 1);
+    ASSERT_EQ(0, x.blocks());
+    ASSERT_EQ(1, y.blocks());
+    ASSERT_EQ(20, x.query(1, 10));
+    ASSERT_EQ(20, y.query(1, 10));}
+
+TEST(CollatzFixture, index_7) {
+    // enough blocks for the table over spans, and an index over the same maxima in place
+    collatz_cache c;
+    collatz_index x(c, 100000, 4);
+    collatz_index y(c, x.maxima(), x.bound(), x.block());
+    ASSERT_LT(4 * collatz_index::span, x.blocks());
+    ASSERT_LT(y.memory(), x.memory() / 10);
+    for (int i = 1; i < 100000; i += 997)
+        for (int j = i; j < 100000; j += 4099) {
+            const int v = collatz_eval(c, i, j);
+            ASSERT_EQ(v, x.query(i, j));
+            ASSERT_EQ(v, y.query(i, j));}}
+
+// -----
+// store
+// -----
+
+TEST(CollatzFixture, store_1) {
+    char p[] = "/tmp/TestCollatz.XXXXXX";
+    close(mkstemp(p));
+    collatz_cache c;
+    collatz_store s(p, 16);
+    ASSERT_EQ( 0, s.bound());
+    ASSERT_EQ(16, s.block());
+    s.extend(c, 1000);
+    ASSERT_EQ(1008, s.bound());
+    collatz_index x(c, 1008, 16);
+    ASSERT_TRUE(equal(x.maxima(), x.maxima() + x.blocks(), s.maxima()));
+    unlink(p);}
+
+TEST(CollatzFixture, store_2) {
+    char p[] = "/tmp/TestCollatz.XXXXXX";
+    close(mkstemp(p));
+    collatz_cache c;
+    collatz_store s(p, 16);
+    s.extend(c, 100);
+    s.extend(c, 500);
+    collatz_store t(p, 64);
+    ASSERT_EQ(512, t.bound());
+    ASSERT_EQ( 16, t.block());
+    ASSERT_TRUE(equal(s.maxima(), s.maxima() + 32, t.maxima()));
+    unlink(p);}
+
+TEST(CollatzFixture, store_3) {
+    char p[] = "/tmp/TestCollatz.XXXXXX";
+    close(mkstemp(p));
+    collatz_cache c;
+    collatz_store s(p, 16);
+    s.extend(c, 100);
+    const int fd = open(p, O_WRONLY);
+    ASSERT_EQ(2, pwrite(fd, "\xff\xff", 2, 40));
+    close(fd);
+    ASSERT_THROW(collatz_store t(p), runtime_error);
+    unlink(p);}
+
+TEST(CollatzFixture, store_4) {
+    char p[] = "/tmp/TestCollatz.XXXXXX";
+    close(mkstemp(p));
+    collatz_cache  c;
+    vector<thread> t;
+    for (int k = 1; k != 5; ++k)
+        t.push_back(thread([&c, &p, k] () {
+            collatz_store s(p, 8);
+            s.extend(c, 1000 * k);}));
+    for (thread& u : t)
+        u.join();
+    collatz_store s(p);
+    collatz_index x(c, s.bound(), 8);
+    ASSERT_EQ(4000, s.bound());
+    ASSERT_TRUE(equal(x.maxima(), x.maxima() + x.blocks(), s.maxima()));
+    unlink(p);}
+
+TEST(CollatzFixture, store_5) {
+    // a range far past the store is scanned, and one near it grows the store, at most doubling it
+    char p[] = "/tmp/TestCollatz.XXXXXX";
+    close(mkstemp(p));
+    collatz_cache c;
+    collatz_store s(p, 16);
+    s.extend(c, 1000);
+    collatz_options o;
+    o.mode  = collatz_indexed;
+    o.store = &s;
+    istringstream r("100000000 100000001\n1500 1600\n");
+    ostringstream w;
+    collatz_solve<long long>(r, w, o);
+    ASSERT_EQ(2016, s.bound());
+    ostringstream e;
+    e << "100000000 100000001 " << collatz_eval(c, 100000000LL, 100000001LL) << "\n"
+      << "1500 1600 "           << collatz_eval(c, 1500, 1600)                << "\n";
+    ASSERT_EQ(e.str(), w.str());
+    unlink(p);}
 
 // -----
 // print
@@ -63,6 +467,26 @@ TEST(CollatzFixture, print) {
     collatz_print(w, 1, 10, 20);
     ASSERT_EQ("1 10 20\n", w.str());}
 
+TEST(CollatzFixture, print_fast) {
+    FILE*          f = tmpfile();
+    collatz_writer w(fileno(f));
+    collatz_print(w, 1, 10, 20);
+    collatz_print(w, -3, 0, 2147483647);
+    w.flush();
+    char b[64] = {};
+    lseek(fileno(f), 0, SEEK_SET);
+    ASSERT_LT(0, read(fileno(f), b, sizeof(b) - 1));
+    ASSERT_STREQ("1 10 20\n-3 0 2147483647\n", b);
+    fclose(f);}
+
+TEST(CollatzFixture, print_fast_2) {
+    const int      fd = open("/dev/null", O_RDONLY);
+    collatz_writer w(fd);
+    collatz_print(w, 1, 10, 20);
+    ASSERT_THROW(w.flush(), runtime_error);
+    w.flush();
+    close(fd);}
+
 // -----
 // solve
 // -----
@@ -71,7 +495,342 @@ TEST(CollatzFixture, solve) {
     istringstream r("1 10\n100 200\n201 210\n900 1000\n");
     ostringstream w;
     collatz_solve(r, w);
-    ASSERT_EQ("1 10 1\n100 200 1\n201 210 1\n900 1000 1\n", w.str());}
+    ASSERT_EQ("1 10 20\n100 200 125\n201 210 89\n900 1000 174\n", w.str());}
+
+TEST(CollatzFixture, solve_indexed) {
+    istringstream   r("1 10\n100 200\n201 210\n900 1000\n");
+    ostringstream   w;
+    collatz_options o;
+    o.mode  = collatz_indexed;
+    o.bound = 1000;
+    collatz_solve(r, w, o);
+    ASSERT_EQ("1 10 20\n100 200 125\n201 210 89\n900 1000 174\n", w.str());}
+
+TEST(CollatzFixture, solve_table) {
+    collatz_cache   c;
+    collatz_index   x(c, 1000, 16);
+    istringstream   r("1 10\n100 200\n201 210\n900 1000\n");
+    ostringstream   w;
+    collatz_options o;
+    o.mode  = collatz_indexed;
+    o.table = x.maxima();
+    o.bound = x.bound();
+    o.block = x.block();
+    collatz_solve(r, w, o);
+    ASSERT_EQ("1 10 20\n100 200 125\n201 210 89\n900 1000 174\n", w.str());}
+
+TEST(CollatzFixture, solve_cache) {
+    // a cache of the caller's counts the solve's lookups, and keeps what it learned
+    collatz_cache   c;
+    collatz_options o;
+    o.cache = &c;
+    istringstream   r1("1 10\n100 200\n");
+    ostringstream   w1;
+    collatz_solve(r1, w1, o);
+    ASSERT_EQ("1 10 20\n100 200 125\n", w1.str());
+    const size_t m = c.misses();
+    ASSERT_LT(0, c.hits() + m);
+    istringstream   r2("100 200\n");
+    ostringstream   w2;
+    collatz_solve(r2, w2, o);
+    ASSERT_EQ("100 200 125\n", w2.str());
+    ASSERT_EQ(m, c.misses());}
+
+TEST(CollatzFixture, solve_store) {
+    char p[] = "/tmp/TestCollatz.XXXXXX";
+    close(mkstemp(p));
+    collatz_store   s(p, 16);
+    istringstream   r("1 10\n100 200\n201 210\n900 1000\n");
+    ostringstream   w;
+    collatz_options o;
+    o.store = &s;
+    collatz_solve(r, w, o);
+    ASSERT_EQ("1 10 20\n100 200 125\n201 210 89\n900 1000 174\n", w.str());
+    ASSERT_LT(1000, s.bound());
+    unlink(p);}
+
+TEST(CollatzFixture, solve_store_small) {
+    // a store of one block of one value is indexed as it is, without reading past its maxima
+    char p[] = "/tmp/TestCollatz.XXXXXX";
+    close(mkstemp(p));
+    collatz_cache c;
+    collatz_store s(p, 1);
+    s.extend(c, 1);
+    ASSERT_EQ(1, s.bound());
+    collatz_index x(c, s.maxima(), s.bound(), s.block());
+    ASSERT_EQ(1, x.bound());
+    ASSERT_EQ(20, x.query(1, 10));
+    istringstream   r("1 1\n1 10\n");
+    ostringstream   w;
+    collatz_options o;
+    o.store = &s;
+    collatz_solve(r, w, o);
+    ASSERT_EQ("1 1 1\n1 10 20\n", w.str());
+    unlink(p);}
+
+TEST(CollatzFixture, print_wide) {
+    ostringstream w;
+    collatz_print(w, 1000000000000LL, 1000000000999LL, 509);
+    ASSERT_EQ("1000000000000 1000000000999 509\n", w.str());}
+
+TEST(CollatzFixture, solve_wide) {
+    istringstream   r("1 10\n1000000000000 1000000000999\n");
+    ostringstream   w;
+    collatz_options o;
+    o.threads = 2;
+    collatz_solve<long long>(r, w, o);
+    ASSERT_EQ("1 10 20\n1000000000000 1000000000999 509\n", w.str());}
+
+TEST(CollatzFixture, solve_threads_1) {
+    istringstream   r("1 10\n100 200\n201 210\n900 1000\n");
+    ostringstream   w;
+    collatz_options o;
+    o.threads = 4;
+    collatz_solve(r, w, o);
+    ASSERT_EQ("1 10 20\n100 200 125\n201 210 89\n900 1000 174\n", w.str());}
+
+TEST(CollatzFixture, solve_fast) {
+    FILE* r = tmpfile();
+    FILE* w = tmpfile();
+    fputs("1 10\n100 200\n201 210\n900 1000\n", r);
+    fflush(r);
+    lseek(fileno(r), 0, SEEK_SET);
+    collatz_solve(fileno(r), fileno(w), collatz_options());
+    char b[64] = {};
+    lseek(fileno(w), 0, SEEK_SET);
+    ASSERT_LT(0, read(fileno(w), b, sizeof(b) - 1));
+    ASSERT_STREQ("1 10 20\n100 200 125\n201 210 89\n900 1000 174\n", b);
+    fclose(r);
+    fclose(w);}
+
+TEST(CollatzFixture, solve_threads_2) {
+    ostringstream s;
+    for (int k = 1; k != 10000; ++k)
+        s << k << " " << ((k * 37) % 5000) + 1 << "\n";
+    istringstream   r1(s.str());
+    istringstream   r2(s.str());
+    ostringstream   w1;
+    ostringstream   w2;
+    collatz_options o;
+    collatz_solve(r1, w1, o);
+    o.mode    = collatz_indexed;
+    o.bound   = 5000;
+    o.threads = 3;
+    collatz_solve(r2, w2, o);
+    ASSERT_EQ(w1.str(), w2.str());}
+
+// -----
+// stats
+// -----
+
+TEST(CollatzFixture, stats_1) {
+    collatz_stats s;
+    collatz_stats t;
+    s.calls[collatz_phase_eval]        = 2;
+    s.histogram[collatz_phase_read][3] = 1;
+    s.hits                             = 5;
+    t.calls[collatz_phase_eval]        = 3;
+    t.steps                            = 7;
+    s += t;
+    ASSERT_EQ(5, s.calls[collatz_phase_eval]);
+    ASSERT_EQ(1, s.histogram[collatz_phase_read][3]);
+    ASSERT_EQ(5, s.hits);
+    ASSERT_EQ(7, s.steps);}
+
+TEST(CollatzFixture, stats_2) {
+    // counts only with -DCOLLATZ_STATS
+    collatz_stats_reset();
+    istringstream r("1 10\n100 200\n");
+    ostringstream w;
+    collatz_solve(r, w);
+    const collatz_stats s = collatz_stats_collect();
+    const uint64_t      n = collatz_stats_enabled() ? 1 : 0;
+    ASSERT_EQ(3 * n, s.calls[collatz_phase_read]);
+    ASSERT_EQ(2 * n, s.calls[collatz_phase_eval]);
+    ASSERT_EQ(2 * n, s.calls[collatz_phase_print]);
+    ASSERT_EQ(collatz_stats_enabled(), s.steps != 0);}
+
+TEST(CollatzFixture, stats_3) {
+    collatz_stats s;
+    s.calls[collatz_phase_eval]        = 4;
+    s.histogram[collatz_phase_eval][2] = 3;
+    s.histogram[collatz_phase_eval][9] = 1;
+    ostringstream w;
+    collatz_stats_dump(w, s);
+    const string d = w.str();
+    ASSERT_NE(string::npos, d.find("eval.calls 4\n"));
+    ASSERT_NE(string::npos, d.find("eval.p50_ns 8\n"));
+    ASSERT_NE(string::npos, d.find("eval.p99_ns 1024\n"));
+    ASSERT_NE(string::npos, d.find("eval.histogram 0 0 3 0 0 0 0 0 0 1 0"));
+    ASSERT_NE(string::npos, d.find("cache.misses 0\n"));}
+
+// ------
+// server
+// ------
+
+namespace {
+
+// sends s to the collatz_server on p, and returns its answers
+string ask (const string& p, const string& s) {
+    const int fd = collatz_connect(p);
+    thread    t([&] () {
+        size_t k = 0;
+        while (k != s.size()) {
+            const ssize_t n = write(fd, s.data() + k, s.size() - k);
+            if (n <= 0)
+                break;
+            k += n;}
+        shutdown(fd, SHUT_WR);});
+    string r;
+    char   b[4096];
+    ssize_t n;
+    while ((n = read(fd, b, sizeof(b))) > 0)
+        r.append(b, n);
+    t.join();
+    close(fd);
+    return r;}
+
+string server_path () {
+    return "/tmp/TestCollatz." + to_string(getpid()) + ".sock";}
+
+} // namespace
+
+TEST(CollatzFixture, server_1) {
+    collatz_server s(server_path());
+    thread         t(&collatz_server::run, &s);
+    ASSERT_EQ("1 10 20\n100 200 125\n201 210 89\n900 1000 174\n", ask(server_path(), "1 10\n100 200\n201 210\n900 1000\n"));
+    ASSERT_EQ("10 1 20\n",                                         ask(server_path(), "10 1"));
+    s.stop();
+    t.join();
+    ASSERT_EQ(5, s.ranges());
+    ASSERT_THROW(collatz_connect(server_path()), runtime_error);}
+
+TEST(CollatzFixture, server_2) {
+    ostringstream i;
+    for (int k = 1; k != 2000; ++k)
+        i << k << " " << ((k * 37) % 5000) + 1 << "\n";
+    istringstream   r(i.str());
+    ostringstream   w;
+    collatz_solve(r, w);
+    collatz_options o;
+    o.mode    = collatz_indexed;
+    o.bound   = 5000;
+    o.threads = 3;
+    collatz_server s(server_path(), o);
+    thread         t(&collatz_server::run, &s);
+    vector<string> a(4);
+    vector<thread> c;
+    for (string& x : a)
+        c.push_back(thread([&] () {x = ask(server_path(), i.str());}));
+    for (thread& x : c)
+        x.join();
+    s.stop();
+    t.join();
+    for (const string& x : a)
+        ASSERT_EQ(w.str(), x);
+    ASSERT_EQ(4 * 1999, s.ranges());
+    ASSERT_LE(s.batches(), s.ranges());}
+
+TEST(CollatzFixture, server_3) {
+    // a queue of one range still answers everything, in order, one batch per range and one for the end
+    ostringstream i;
+    ostringstream w;
+    for (int k = 1; k != 500; ++k) {
+        i << k << " " << (k + 10) << "\n";
+        w << k << " " << (k + 10) << " " << collatz_eval(k, k + 10) << "\n";}
+    collatz_server s(server_path(), collatz_options(), 1);
+    thread         t(&collatz_server::run, &s);
+    ASSERT_EQ(w.str(), ask(server_path(), i.str()));
+    s.stop();
+    t.join();
+    ASSERT_EQ(500, s.batches());}
+
+TEST(CollatzFixture, server_4) {
+    // stop answers what an open connection already sent, then ends it
+    collatz_server s(server_path());
+    thread         t(&collatz_server::run, &s);
+    const int      fd = collatz_connect(server_path());
+    ASSERT_EQ(5, write(fd, "1 10\n", 5));
+    char    b[64];
+    ssize_t n = read(fd, b, sizeof(b));
+    ASSERT_EQ("1 10 20\n", string(b, max<ssize_t>(n, 0)));
+    s.stop();
+    t.join();
+    ASSERT_EQ(0, read(fd, b, sizeof(b)));
+    close(fd);}
+
+TEST(CollatzFixture, server_5) {
+    // a range that isn't two positive ints ends its connection
+    collatz_server s(server_path());
+    thread         t(&collatz_server::run, &s);
+    ASSERT_EQ("1 10 20\n", ask(server_path(), "1 10\n0 5\n3 4\n"));
+    ASSERT_EQ("1 10 20\n", ask(server_path(), "1 10\n3 x\n"));
+    s.stop();
+    t.join();}
+
+TEST(CollatzFixture, server_6) {
+    // a client that goes away before its answers raises no SIGPIPE, and the next one is answered
+    collatz_server s(server_path());
+    thread         t(&collatz_server::run, &s);
+    const int      fd = collatz_connect(server_path());
+    ASSERT_EQ(15, write(fd, "1 10\n2 20\n3 30\n", 15));
+    close(fd);
+    ASSERT_EQ("1 10 20\n", ask(server_path(), "1 10\n"));
+    s.stop();
+    t.join();}
+
+TEST(CollatzFixture, server_7) {
+    // a client that never reads stalls only itself, and stop still returns
+    collatz_server s(server_path(), collatz_options(), 64);
+    thread         t(&collatz_server::run, &s);
+    const int      fd = collatz_connect(server_path());
+    thread         u([fd] () {
+        string x;
+        for (int k = 0; k != 200000; ++k)
+            x += "1000000 1000000\n";
+        size_t k = 0;
+        while (k != x.size()) {
+            const ssize_t n = send(fd, x.data() + k, x.size() - k, MSG_NOSIGNAL);
+            if (n <= 0)
+                break;
+            k += n;}});
+    // until its answers fill the socket and the server stops reading it
+    size_t r;
+    do {
+        r = s.ranges();
+        this_thread::sleep_for(chrono::milliseconds(200));}
+    while ((r == 0) || (s.ranges() != r));
+    ASSERT_LT(r, 200000);
+    ASSERT_EQ("1 10 20\n", ask(server_path(), "1 10\n"));
+    s.stop();
+    t.join();
+    u.join();
+    close(fd);}
+
+// ----
+// pool
+// ----
+
+TEST(CollatzFixture, pool_1) {
+    // an exception in a worker is rethrown by run, after every other call has returned
+    collatz_pool                  p(4);
+    atomic<int>                   n(0);
+    const function<void (size_t)> f = [&] (size_t k) {
+        ++n;
+        if (k == 5)
+            throw overflow_error("pool_1");};
+    ASSERT_THROW(p.run(100, f), overflow_error);
+    ASSERT_EQ(100, n.load());
+    vector<size_t> v(10);
+    p.run(v.size(), [&] (size_t k) {v[k] = k;});
+    for (size_t k = 0; k != v.size(); ++k)
+        ASSERT_EQ(k, v[k]);}
+
+TEST(CollatzFixture, pool_2) {
+    // the calling thread's exception too
+    collatz_pool p(1);
+    ASSERT_THROW(p.run(3, [] (size_t) {throw runtime_error("pool_2");}), runtime_error);
+    p.run(3, [] (size_t) {});}
 
 /*
 % g++-4.8 -pedantic -std=c++11 -Wall -fprofile-arcs -ftest-coverage Collatz.c++ TestCollatz.c++ -o TestCollatz -lgtest -lgtest_main -pthread
@@ -4,11 +4,17 @@
 
 // http://www.cplusplus.com/reference/algorithm/all_of/
 
-#include <algorithm>  // all_of
+#include <algorithm>  // all_of, any_of, none_of
+#include <atomic>     // atomic
 #include <cassert>    // assert
+#include <cstddef>    // size_t
 #include <functional> // function
 #include <iostream>   // cout, endl
 #include <list>       // list
+#include <numeric>    // iota
+#include <stdexcept>  // domain_error
+#include <thread>     // yield
+#include <vector>     // vector
 
 #include "gtest/gtest.h"
 
@@ -38,6 +44,91 @@ TEST_P(AllOfListFixture, test_2) {
     const list<int> x = {3, 5, 7};
     ASSERT_TRUE(GetParam()(begin(x), end(x), [n] (int v) -> bool {return (v % n);}));}
 
+using AnyOfListSignature = function<bool (list<int>::const_iterator, list<int>::const_iterator, function<bool (int)>)>;
+
+struct AnyOfListFixture : TestWithParam<AnyOfListSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    AnyOfListInstantiation,
+    AnyOfListFixture,
+    Values(
+           any_of<list<int>::const_iterator, function<bool (int)>>,
+        my_any_of<list<int>::const_iterator, function<bool (int)>>));
+
+TEST_P(AnyOfListFixture, test_1) {
+    const list<int> x = {3, 6, 7};
+    ASSERT_TRUE(GetParam()(begin(x), end(x), [] (int v) -> bool {return !(v % 2);}));}
+
+TEST_P(AnyOfListFixture, test_2) {
+    const list<int> x = {3, 5, 7};
+    ASSERT_FALSE(GetParam()(begin(x), end(x), [] (int v) -> bool {return !(v % 2);}));}
+
+using NoneOfListSignature = function<bool (list<int>::const_iterator, list<int>::const_iterator, function<bool (int)>)>;
+
+struct NoneOfListFixture : TestWithParam<NoneOfListSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    NoneOfListInstantiation,
+    NoneOfListFixture,
+    Values(
+           none_of<list<int>::const_iterator, function<bool (int)>>,
+        my_none_of<list<int>::const_iterator, function<bool (int)>>));
+
+TEST_P(NoneOfListFixture, test_1) {
+    const list<int> x = {3, 6, 7};
+    ASSERT_FALSE(GetParam()(begin(x), end(x), [] (int v) -> bool {return !(v % 2);}));}
+
+TEST_P(NoneOfListFixture, test_2) {
+    const list<int> x = {3, 5, 7};
+    ASSERT_TRUE(GetParam()(begin(x), end(x), [] (int v) -> bool {return !(v % 2);}));}
+
+// the parallel overloads, by number of threads
+struct ParallelFixture : TestWithParam<size_t>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    ParallelInstantiation,
+    ParallelFixture,
+    Values(1, 2, 3, 8));
+
+TEST_P(ParallelFixture, test_1) {
+    const vector<int> x;
+    ASSERT_TRUE (my_all_of (my_parallel(GetParam()), begin(x), end(x), [] (int) -> bool {return false;}));
+    ASSERT_FALSE(my_any_of (my_parallel(GetParam()), begin(x), end(x), [] (int) -> bool {return true;}));
+    ASSERT_TRUE (my_none_of(my_parallel(GetParam()), begin(x), end(x), [] (int) -> bool {return true;}));}
+
+// one failure, anywhere, with chunks of every size
+TEST_P(ParallelFixture, test_2) {
+    vector<int> x(1000);
+    iota(begin(x), end(x), 0);
+    for (size_t g : {0, 1, 7, 1000})
+        for (int k : {-1, 0, 1, 499, 998, 999}) {
+            const auto f = [k] (int v) -> bool {return v != k;};
+            ASSERT_EQ(my_all_of (my_parallel(GetParam(), g), begin(x), end(x), f), all_of (begin(x), end(x), f));
+            ASSERT_EQ(my_any_of (my_parallel(GetParam(), g), begin(x), end(x), [&] (int v) {return !f(v);}), any_of (begin(x), end(x), [&] (int v) {return !f(v);}));
+            ASSERT_EQ(my_none_of(my_parallel(GetParam(), g), begin(x), end(x), [&] (int v) {return !f(v);}), none_of(begin(x), end(x), [&] (int v) {return !f(v);}));}}
+
+// every call waits for the failure at the start, so without the shared flag every worker would go on to the end of its run
+TEST_P(ParallelFixture, test_3) {
+    vector<int> x(100000, 1);
+    x[0] = 0;
+    atomic<bool>   seen(false);
+    atomic<size_t> n(0);
+    ASSERT_FALSE(my_all_of(my_parallel(GetParam(), 1), begin(x), end(x), [&] (int v) -> bool {
+        ++n;
+        if (!v)
+            seen = true;
+        while (!seen)
+            this_thread::yield();
+        return v;}));
+    ASSERT_LT(n.load(), x.size() / 2);}
+
+TEST_P(ParallelFixture, test_4) {
+    const vector<int> x(1000, 1);
+    ASSERT_THROW(my_all_of(my_parallel(GetParam()), begin(x), end(x), [] (int) -> bool {throw domain_error("f");}), domain_error);}
+
 /*
 % AllOf
 Running main() from gtest_main.cc
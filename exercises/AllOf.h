@@ -5,6 +5,17 @@
 #ifndef AllOf_h
 #define AllOf_h
 
+#include <algorithm>   // max, min
+#include <atomic>      // atomic, memory_order_relaxed
+#include <cstddef>     // size_t
+#include <cstdint>     // uintptr_t
+#include <exception>   // current_exception, exception_ptr, rethrow_exception
+#include <iterator>    // iterator_traits, random_access_iterator_tag
+#include <new>         // placement new
+#include <thread>      // thread
+#include <type_traits> // decay, enable_if, is_base_of, is_same
+#include <vector>      // vector
+
 template <typename II, typename UP>
 bool my_all_of (II b, II e, UP f) {
     while (b != e) {
@@ -13,4 +24,118 @@ bool my_all_of (II b, II e, UP f) {
         ++b;}
     return true;}
 
+template <typename II, typename UP>
+bool my_any_of (II b, II e, UP f) {
+    while (b != e) {
+        if (f(*b))
+            return true;
+        ++b;}
+    return false;}
+
+template <typename II, typename UP>
+bool my_none_of (II b, II e, UP f) {
+    return !my_any_of(b, e, f);}
+
+/*
+the parallel overloads take a my_parallel first, the way the C++17 ones take an execution policy
+
+the range is cut into chunks, and each worker starts with its own run of them;
+a worker that has finished its run steals the unclaimed chunks of the others, so a slow run doesn't hold up the rest
+the first worker to find the answer raises a shared flag, and every worker checks it before each element,
+so the search stops within one call of f everywhere
+
+f is called concurrently, and may be called on elements past the one that decided the answer
+if f throws, the search stops and the first exception is rethrown to the caller
+if a thread can't be started, the ones that did, and the caller, steal its run, so the answer is the same
+*/
+
+struct my_parallel {
+    std::size_t threads;
+    std::size_t grain;   // elements per chunk, 0 for about 16 chunks per thread
+
+    explicit my_parallel (std::size_t t = std::thread::hardware_concurrency(), std::size_t g = 0) :
+            threads (std::max<std::size_t>(t, 1)),
+            grain   (g)
+        {}};
+
+template <typename P, typename RI>
+using my_if_parallel = typename std::enable_if<
+        std::is_same<typename std::decay<P>::type, my_parallel>::value &&
+        std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<RI>::iterator_category>::value,
+    bool>::type;
+
+/**
+ * @return true if f(x) == v for some x in [b, e)
+ */
+template <typename RI, typename UP>
+bool my_parallel_find (const my_parallel& p, RI b, RI e, UP& f, bool v) {
+    const std::size_t n = e - b;
+    if (n == 0)
+        return false;
+    const std::size_t t = std::min(p.threads, n);
+    const std::size_t g = (p.grain != 0) ? p.grain : std::max<std::size_t>(1, n / (16 * t));
+    const std::size_t c = (n + g - 1) / g;
+
+    // the chunks [next, end) not yet claimed, on their own cache line
+    struct alignas(64) run {
+        std::atomic<std::size_t> next;
+        std::size_t              end;};
+
+    // vector aligns only to 16 before C++17, so the runs are placed on a 64-byte boundary by hand
+    std::vector<unsigned char> m((t + 1) * sizeof(run));
+    run* const r = reinterpret_cast<run*>((reinterpret_cast<std::uintptr_t>(m.data()) + 63) & ~std::uintptr_t(63));
+    for (std::size_t w = 0; w != t; ++w) {
+        new (r + w) run;
+        r[w].next.store((w * c) / t, std::memory_order_relaxed);
+        r[w].end = ((w + 1) * c) / t;}
+
+    std::atomic<bool>  found(false);
+    std::atomic<bool>  failed(false);
+    std::exception_ptr x;
+
+    const auto work = [&] (std::size_t w) {
+        try {
+            for (std::size_t k = 0; k != t; ++k) {
+                run& q = r[(w + k) % t];
+                std::size_t i;
+                while (!found.load(std::memory_order_relaxed) && ((i = q.next.fetch_add(1, std::memory_order_relaxed)) < q.end)) {
+                    RI       j = b + (i * g);
+                    const RI l = (((i + 1) * g) < n) ? (j + g) : e;
+                    for (; j != l; ++j) {
+                        if (found.load(std::memory_order_relaxed))
+                            return;
+                        if (bool(f(*j)) == v) {
+                            found.store(true, std::memory_order_relaxed);
+                            return;}}}}}
+        catch (...) {
+            if (!failed.exchange(true))
+                x = std::current_exception();
+            found.store(true, std::memory_order_relaxed);}};
+
+    std::vector<std::thread> h;
+    try {
+        h.reserve(t - 1);
+        for (std::size_t w = 1; w != t; ++w)
+            h.emplace_back(work, w);}
+    catch (...)
+        {}
+    work(0);
+    for (std::thread& y : h)
+        y.join();
+    if (x)
+        std::rethrow_exception(x);
+    return found.load(std::memory_order_relaxed);}
+
+template <typename P, typename RI, typename UP>
+my_if_parallel<P, RI> my_all_of (P&& p, RI b, RI e, UP f) {
+    return !my_parallel_find(p, b, e, f, false);}
+
+template <typename P, typename RI, typename UP>
+my_if_parallel<P, RI> my_any_of (P&& p, RI b, RI e, UP f) {
+    return my_parallel_find(p, b, e, f, true);}
+
+template <typename P, typename RI, typename UP>
+my_if_parallel<P, RI> my_none_of (P&& p, RI b, RI e, UP f) {
+    return !my_parallel_find(p, b, e, f, true);}
+
 #endif // AllOf_h
@@ -0,0 +1,117 @@
+// -------
+// Arena.h
+// -------
+
+// http://en.cppreference.com/w/cpp/memory/monotonic_buffer_resource
+
+#ifndef Arena_h
+#define Arena_h
+
+#include <algorithm> // max
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <cstdint>   // uintptr_t
+#include <new>       // bad_alloc, operator new
+
+/*
+a monotonic arena: allocation bumps a pointer through blocks that double in size,
+and nothing is given back until the arena is destroyed
+many short-lived containers can draw from one arena through a my_arena_allocator
+and cost one heap allocation per block instead of one per chunk each
+*/
+
+class my_arena {
+    private:
+        struct block {
+            block*      next;
+            std::size_t size;};
+
+        block*      _blocks;
+        char*       _p;
+        char*       _e;
+        std::size_t _next;
+        std::size_t _count;
+
+    public:
+        /**
+         * @param initial the size of the first block
+         */
+        explicit my_arena (std::size_t initial = 4096) :
+                _blocks (nullptr),
+                _p      (nullptr),
+                _e      (nullptr),
+                _next   (std::max<std::size_t>(initial, 64)),
+                _count  (0)
+            {}
+
+        my_arena             (const my_arena&) = delete;
+        my_arena& operator = (const my_arena&) = delete;
+
+        ~my_arena () {
+            while (_blocks != nullptr) {
+                block* const b = _blocks;
+                _blocks = b->next;
+                ::operator delete(b);}}
+
+        /**
+         * @param n     the number of bytes
+         * @param align a power of 2
+         * @return n bytes aligned to align, valid until the arena is destroyed
+         */
+        void* allocate (std::size_t n, std::size_t align) {
+            assert((align & (align - 1)) == 0);
+            std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(_p) + (align - 1)) & ~std::uintptr_t(align - 1);
+            if ((_p == nullptr) || ((p + n) > reinterpret_cast<std::uintptr_t>(_e))) {
+                const std::size_t s = std::max(_next, sizeof(block) + n + align);
+                block* const      b = static_cast<block*>(::operator new(s));
+                b->next = _blocks;
+                b->size = s;
+                _blocks = b;
+                _p      = reinterpret_cast<char*>(b + 1);
+                _e      = reinterpret_cast<char*>(b) + s;
+                _next   = 2 * s;
+                ++_count;
+                p = (reinterpret_cast<std::uintptr_t>(_p) + (align - 1)) & ~std::uintptr_t(align - 1);}
+            _p = reinterpret_cast<char*>(p + n);
+            return reinterpret_cast<void*>(p);}
+
+        /**
+         * @return the number of blocks taken from the heap
+         */
+        std::size_t blocks () const {
+            return _count;}};
+
+template <typename T>
+class my_arena_allocator {
+    public:
+        using value_type = T;
+
+        friend bool operator == (const my_arena_allocator& lhs, const my_arena_allocator& rhs) {
+            return lhs._a == rhs._a;}
+
+        friend bool operator != (const my_arena_allocator& lhs, const my_arena_allocator& rhs) {
+            return !(lhs == rhs);}
+
+    private:
+        my_arena* _a;
+
+    public:
+        explicit my_arena_allocator (my_arena& a) :
+                _a (&a)
+            {}
+
+        template <typename U>
+        my_arena_allocator (const my_arena_allocator<U>& rhs) :
+                _a (rhs.arena())
+            {}
+
+        T* allocate (std::size_t n) {
+            return static_cast<T*>(_a->allocate(n * sizeof(T), alignof(T)));}
+
+        void deallocate (T*, std::size_t)
+            {}
+
+        my_arena* arena () const {
+            return _a;}};
+
+#endif // Arena_h
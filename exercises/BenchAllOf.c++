@@ -0,0 +1,61 @@
+// --------------
+// BenchAllOf.c++
+// --------------
+
+// my_all_of over an expensive predicate: serial, and parallel on 1 to N threads,
+// with the first failing element at several places, or none
+
+#include <algorithm> // max
+#include <chrono>    // duration, steady_clock
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <cstdio>    // printf
+#include <cstdlib>   // strtoul
+#include <thread>    // thread
+#include <vector>    // vector
+
+#include "AllOf.h"
+
+using namespace std;
+
+// about a microsecond of arithmetic; false only for 0
+inline bool expensive (uint64_t v) {
+    uint64_t h = v;
+    for (int i = 0; i != 256; ++i) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;}
+    return (v != 0) || (h == 1);}
+
+template <typename F>
+double run (F f) {
+    const chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    if (f())
+        printf("?");
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - b).count();}
+
+int main (int argc, char* argv[]) {
+    const size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t m = max<size_t>(4, thread::hardware_concurrency());
+    printf("%-10s %10s", "failure", "serial");
+    for (size_t t = 1; t <= m; t *= 2)
+        printf(" %8zu th", t);
+    printf("   (ms)\n");
+    for (double at : {0.01, 0.5, 0.99, 1.0}) {
+        vector<uint64_t> x(n, 1);
+        if (at < 1.0)
+            x[size_t(at * n)] = 0;
+        const bool all = at == 1.0;
+        if (all)
+            printf("%-10s", "none");
+        else
+            printf("%-10.2f", at);
+        printf(" %10.1f", run([&] () {return my_all_of(x.begin(), x.end(), expensive) != all;}));
+        for (size_t t = 1; t <= m; t *= 2)
+            printf(" %11.1f", run([&] () {return my_all_of(my_parallel(t), x.begin(), x.end(), expensive) != all;}));
+        printf("\n");}
+    return 0;}
+
+/*
+% g++ -pedantic -std=c++11 -Wall -O2 -DNDEBUG BenchAllOf.c++ -o BenchAllOf -pthread
+% ./BenchAllOf
+*/
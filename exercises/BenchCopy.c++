@@ -0,0 +1,64 @@
+// -------------
+// BenchCopy.c++
+// -------------
+
+// bytes per second of copy, fill and equal over vector<int>, by size:
+// the element-at-a-time loop, my_ with its byte fast paths, and std::
+
+#include <algorithm>   // copy, equal, fill, max
+#include <chrono>      // duration, steady_clock
+#include <cstddef>     // size_t
+#include <cstdio>      // printf
+#include <cstdlib>     // strtoul
+#include <type_traits> // false_type
+#include <vector>      // vector
+
+#include "Copy.h"
+#include "Equal.h"
+#include "Fill.h"
+
+using namespace std;
+
+// keeps the compiler from dropping work whose result isn't otherwise used
+inline void keep (const void* p) {
+    asm volatile ("" : : "r"(p) : "memory");}
+
+// calls f enough times to touch about t bytes; returns gigabytes per second
+template <typename F>
+double run (size_t n, size_t t, F f) {
+    const size_t r = max<size_t>(1, t / n);
+    const chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t i = 0; i != r; ++i)
+        f();
+    const double s = chrono::duration<double>(chrono::steady_clock::now() - b).count();
+    return (double(r) * n) / s / 1e9;}
+
+int main (int argc, char* argv[]) {
+    const size_t t = (argc > 1) ? strtoul(argv[1], nullptr, 10) : (size_t(1) << 30);
+    printf("%-10s %-6s %10s %10s %10s\n", "bytes", "", "loop", "my_", "std::");
+    for (size_t n = 64; n <= (size_t(1) << 26); n *= 8) {
+        const size_t m = n / sizeof(int);
+        vector<int>       x(m, 1);
+        vector<int>       y(m, 1);
+        bool              q = true;
+        printf("%-10zu %-6s %10.2f %10.2f %10.2f\n", n, "copy",
+            run(n, t, [&] () {my_copy_dispatch(x.cbegin(), x.cend(), y.begin(), false_type()); keep(y.data());}),
+            run(n, t, [&] () {my_copy         (x.cbegin(), x.cend(), y.begin());               keep(y.data());}),
+            run(n, t, [&] () {copy            (x.cbegin(), x.cend(), y.begin());               keep(y.data());}));
+        printf("%-10s %-6s %10.2f %10.2f %10.2f\n", "", "fill",
+            run(n, t, [&] () {my_fill_dispatch(y.begin(), y.end(), 2, false_type()); keep(y.data());}),
+            run(n, t, [&] () {my_fill         (y.begin(), y.end(), 2);               keep(y.data());}),
+            run(n, t, [&] () {fill            (y.begin(), y.end(), 2);               keep(y.data());}));
+        y = x;
+        printf("%-10s %-6s %10.2f %10.2f %10.2f\n", "", "equal",
+            run(n, t, [&] () {q &= my_equal_dispatch(x.cbegin(), x.cend(), y.cbegin(), false_type()); keep(&q);}),
+            run(n, t, [&] () {q &= my_equal         (x.cbegin(), x.cend(), y.cbegin());               keep(&q);}),
+            run(n, t, [&] () {q &= equal            (x.cbegin(), x.cend(), y.cbegin());               keep(&q);}));
+        if (!q)
+            return 1;}
+    return 0;}
+
+/*
+% g++ -pedantic -std=c++11 -Wall -O2 -DNDEBUG BenchCopy.c++ -o BenchCopy -pthread
+% ./BenchCopy
+*/
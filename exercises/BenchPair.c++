@@ -0,0 +1,67 @@
+// -------------
+// BenchPair.c++
+// -------------
+
+// a scan of the keys of n key-value pairs, and a scan of keys and values,
+// over vector<pair> and over my_pair_vector, by the size of the value
+
+#include <chrono>  // duration, steady_clock
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <cstdio>  // printf
+#include <cstdlib> // strtoul
+#include <utility> // pair
+#include <vector>  // vector
+
+#include "PairVector.h"
+
+using namespace std;
+
+template <size_t N>
+struct payload {
+    uint64_t v[N / 8];};
+
+// calls f r times; returns nanoseconds per element
+template <typename F>
+double run (size_t n, size_t r, F f) {
+    uint64_t s = 0;
+    const chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t i = 0; i != r; ++i)
+        s += f();
+    const double t = chrono::duration<double, nano>(chrono::steady_clock::now() - b).count();
+    if (s == 1)
+        printf("?");
+    return t / (double(n) * r);}
+
+template <size_t N>
+void bench (size_t n, size_t r) {
+    vector<pair<uint64_t, payload<N>>> x;
+    my_pair_vector<uint64_t, payload<N>> y;
+    x.reserve(n);
+    y.reserve(n);
+    for (uint64_t i = 0; i != n; ++i) {
+        payload<N> p = {};
+        p.v[0] = i;
+        x.emplace_back(i * 7, p);
+        y.emplace_back(i * 7, p);}
+    printf("%-8zu %-6s %14.3f %14.3f\n", N, "keys",
+        run(n, r, [&] () {uint64_t s = 0; for (const pair<uint64_t, payload<N>>& p : x) s += p.first; return s;}),
+        run(n, r, [&] () {uint64_t s = 0; for (uint64_t k : y.firsts())                 s += k;       return s;}));
+    printf("%-8s %-6s %14.3f %14.3f\n", "", "both",
+        run(n, r, [&] () {uint64_t s = 0; for (const pair<uint64_t, payload<N>>& p : x)                 s += p.first + p.second.v[0]; return s;}),
+        run(n, r, [&] () {uint64_t s = 0; for (my_pair<const uint64_t&, const payload<N>&> p : y) s += p.first + p.second.v[0]; return s;}));}
+
+int main (int argc, char* argv[]) {
+    const size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t r = 20;
+    printf("%-8s %-6s %14s %14s   (ns per element)\n", "value", "scan", "vector<pair>", "my_pair_vector");
+    bench<8>  (n, r);
+    bench<24> (n, r);
+    bench<56> (n, r);
+    bench<120>(n, r);
+    return 0;}
+
+/*
+% g++ -pedantic -std=c++11 -Wall -O2 -DNDEBUG BenchPair.c++ -o BenchPair -pthread
+% ./BenchPair
+*/
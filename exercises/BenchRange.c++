@@ -0,0 +1,73 @@
+// --------------
+// BenchRange.c++
+// --------------
+
+// a sum over Range(0, n): a sequential loop, a thread per chunk, and the C++17 policies
+// Range's iterators are input iterators to the C++17 library, so par doesn't split the work; chunks does
+
+#include <algorithm>  // max
+#include <chrono>     // duration, steady_clock
+#include <cstdint>    // uint64_t
+#include <cstdio>     // printf
+#include <cstdlib>    // strtoull
+#include <execution>  // par, par_unseq, seq
+#include <functional> // plus
+#include <numeric>    // transform_reduce
+#include <thread>     // thread
+#include <vector>     // vector
+
+#include "Range.h"
+
+using namespace std;
+
+// a little work per index, so the sum isn't just memory bandwidth
+inline uint64_t work (uint64_t i) {
+    i ^= i >> 33;
+    i *= 0xff51afd7ed558ccdULL;
+    return i ^ (i >> 33);}
+
+template <typename F>
+void run (const char* name, F f) {
+    const chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    const uint64_t s = f();
+    const double   t = chrono::duration<double>(chrono::steady_clock::now() - b).count();
+    printf("%-16s %20llu %10.3f\n", name, (unsigned long long)s, t);}
+
+int main (int argc, char* argv[]) {
+    const long long       n = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 1000000000;
+    const Range<long long> x(0, n);
+    const size_t          c = max<unsigned>(1, thread::hardware_concurrency());
+    printf("%-16s %20s %10s\n", "mode", "sum", "seconds");
+    run("loop", [&] () {
+        uint64_t s = 0;
+        for (long long i : x)
+            s += work(i);
+        return s;});
+    run("threads", [&] () {
+        const vector<Range<long long>> v = x.chunks(c);
+        vector<uint64_t>               s(c);
+        vector<thread>                 t;
+        for (size_t k = 0; k != c; ++k)
+            t.push_back(thread([&, k] () {
+                uint64_t a = 0;
+                for (long long i : v[k])
+                    a += work(i);
+                s[k] = a;}));
+        for (thread& h : t)
+            h.join();
+        uint64_t a = 0;
+        for (uint64_t e : s)
+            a += e;
+        return a;});
+    run("seq", [&] () {
+        return transform_reduce(execution::seq,       x.begin(), x.end(), uint64_t(0), plus<uint64_t>(), work);});
+    run("par", [&] () {
+        return transform_reduce(execution::par,       x.begin(), x.end(), uint64_t(0), plus<uint64_t>(), work);});
+    run("par_unseq", [&] () {
+        return transform_reduce(execution::par_unseq, x.begin(), x.end(), uint64_t(0), plus<uint64_t>(), work);});
+    return 0;}
+
+/*
+% g++ -pedantic -std=c++17 -Wall -O2 -DNDEBUG BenchRange.c++ -o BenchRange -pthread -ltbb
+% ./BenchRange
+*/
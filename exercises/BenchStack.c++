@@ -0,0 +1,86 @@
+// --------------
+// BenchStack.c++
+// --------------
+
+// pushes and pops on one stack shared by 1 to N threads:
+// my_lock_free_stack against my_stack and stack, each behind a mutex
+
+#include <algorithm> // max
+#include <atomic>    // atomic, memory_order_*
+#include <chrono>    // duration, steady_clock
+#include <cstdio>    // printf
+#include <cstdlib>   // strtoul
+#include <deque>     // deque
+#include <mutex>     // lock_guard, mutex
+#include <stack>     // stack
+#include <thread>    // thread, yield
+#include <vector>    // vector
+
+#include "LockFreeStack.h"
+#include "Stack.h"
+
+using namespace std;
+
+// a stack behind one mutex, the way a shared my_stack is used today
+template <typename S>
+class locked {
+    private:
+        mutex _m;
+        S     _s;
+
+    public:
+        void push (int v) {
+            lock_guard<mutex> l(_m);
+            _s.push(v);}
+
+        bool try_pop (int& v) {
+            lock_guard<mutex> l(_m);
+            if (_s.empty())
+                return false;
+            v = _s.top();
+            _s.pop();
+            return true;}};
+
+// n operations per thread, each a push followed by a pop; returns operations per second
+// the clock starts once every thread is up and waiting, so thread creation isn't timed
+template <typename S>
+double run (size_t t, size_t n) {
+    S x;
+    for (int i = 0; i != 1024; ++i)
+        x.push(i);
+    atomic<size_t> ready(0);
+    atomic<bool>   go(false);
+    vector<thread> ts;
+    for (size_t k = 0; k != t; ++k)
+        ts.push_back(thread([&] () {
+            ++ready;
+            while (!go.load(memory_order_acquire))
+                this_thread::yield();
+            int v = 0;
+            for (size_t i = 0; i != n; ++i) {
+                x.push(v);
+                x.try_pop(v);}}));
+    while (ready.load() != t)
+        this_thread::yield();
+    const chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    go.store(true, memory_order_release);
+    for (thread& h : ts)
+        h.join();
+    const double s = chrono::duration<double>(chrono::steady_clock::now() - b).count();
+    return (2.0 * t * n) / s;}
+
+int main (int argc, char* argv[]) {
+    const size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t m = max<size_t>(4, thread::hardware_concurrency());
+    printf("%-8s %16s %16s %16s\n", "threads", "lock_free", "my_stack+mutex", "stack+mutex");
+    for (size_t t = 1; t <= m; t *= 2)
+        printf("%-8zu %16.0f %16.0f %16.0f\n", t,
+            run<my_lock_free_stack<int>>(t, n),
+            run<locked<my_stack<int>>>  (t, n),
+            run<locked<stack<int>>>     (t, n));
+    return 0;}
+
+/*
+% g++ -pedantic -std=c++11 -Wall -O2 -DNDEBUG BenchStack.c++ -o BenchStack -pthread
+% ./BenchStack
+*/
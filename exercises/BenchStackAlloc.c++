@@ -0,0 +1,91 @@
+// -------------------
+// BenchStackAlloc.c++
+// -------------------
+
+// heap allocations and time per short-lived stack, by backing container,
+// and per push of a string, by copy and by move
+
+#include <chrono>  // duration, steady_clock
+#include <cstddef> // size_t
+#include <cstdio>  // printf
+#include <cstdlib> // free, malloc, strtoul
+#include <deque>   // deque
+#include <new>     // bad_alloc
+#include <string>  // string
+#include <utility> // move
+#include <vector>  // vector
+
+#include "Arena.h"
+#include "Stack.h"
+
+using namespace std;
+
+namespace {
+
+size_t allocations = 0;
+
+} // namespace
+
+void* operator new (size_t n) {
+    ++allocations;
+    if (void* p = malloc(n))
+        return p;
+    throw bad_alloc();}
+
+void operator delete (void* p) noexcept {
+    free(p);}
+
+void operator delete (void* p, size_t) noexcept {
+    free(p);}
+
+namespace {
+
+using arena_allocator = my_arena_allocator<int>;
+
+// s stacks of k ints each; make(a) makes a stack, drawing from the arena a if it wants to
+template <typename F>
+void run (const char* name, size_t s, size_t k, F make) {
+    const size_t before = allocations;
+    const chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t i = 0; i != s; i += 1000) {
+        // an arena per 1000 stacks, as for the stacks of one request
+        my_arena a;
+        for (size_t j = 0; j != 1000; ++j) {
+            auto x = make(a);
+            for (size_t v = 0; v != k; ++v)
+                x.push(int(v));}}
+    const double t = chrono::duration<double>(chrono::steady_clock::now() - b).count();
+    printf("%-26s %6zu %14.3f %12.1f\n", name, k, double(allocations - before) / s, (1e9 * t) / s);}
+
+template <typename P>
+void strings (const char* name, size_t n, P push) {
+    my_stack<string, vector<string>> x;
+    x.emplace();
+    vector<string> v(n, string(64, 'a'));
+    const size_t before = allocations;
+    const chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (string& s : v)
+        push(x, s);
+    const double t = chrono::duration<double>(chrono::steady_clock::now() - b).count();
+    printf("%-26s %6s %14.3f %12.1f\n", name, "-", double(allocations - before) / n, (1e9 * t) / n);}
+
+} // namespace
+
+int main (int argc, char* argv[]) {
+    const size_t s = (argc > 1) ? ((strtoul(argv[1], nullptr, 10) + 999) / 1000) * 1000 : 100000;
+    printf("%-26s %6s %14s %12s\n", "stack", "size", "allocations", "ns");
+    for (size_t k : {0, 1, 4, 16, 64}) {
+        run("my_stack<deque>",         s, k, [] (my_arena&) {return my_stack<int>();});
+        run("my_stack<vector>",        s, k, [] (my_arena&) {return my_stack<int, vector<int>>();});
+        run("my_small_stack<16>",      s, k, [] (my_arena&) {return my_small_stack<int, 16>();});
+        run("my_stack<deque, arena>",  s, k, [] (my_arena& a) {return my_stack<int, deque <int, arena_allocator>>(arena_allocator(a));});
+        run("my_stack<vector, arena>", s, k, [] (my_arena& a) {return my_stack<int, vector<int, arena_allocator>>(arena_allocator(a));});
+        run("my_small_stack<16, arena>", s, k, [] (my_arena& a) {return my_small_stack<int, 16, arena_allocator>(arena_allocator(a));});}
+    strings("push copy", s, [] (my_stack<string, vector<string>>& x, string& v) {x.push(v);});
+    strings("push move", s, [] (my_stack<string, vector<string>>& x, string& v) {x.push(move(v));});
+    return 0;}
+
+/*
+% g++ -pedantic -std=c++11 -Wall -O2 -DNDEBUG BenchStackAlloc.c++ -o BenchStackAlloc -pthread
+% ./BenchStackAlloc
+*/
@@ -9,6 +9,8 @@
 #include <functional> // function
 #include <iostream>   // cout, endl
 #include <list>       // list
+#include <numeric>    // iota
+#include <string>     // string
 #include <vector>     // vector
 
 #include "gtest/gtest.h"
@@ -46,6 +48,98 @@ TEST_P(CopyListFixture, test_2) {
     ASSERT_EQ(p, begin(y) + 5);
     ASSERT_TRUE(equal(begin(y), y.end(), z.begin()));}
 
+using CopyVectorSignature = function<vector<int>::iterator (vector<int>::const_iterator, vector<int>::const_iterator, vector<int>::iterator)>;
+
+struct CopyVectorFixture : TestWithParam<CopyVectorSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    CopyVectorInstantiation,
+    CopyVectorFixture,
+    Values(
+           copy<vector<int>::const_iterator, vector<int>::iterator>,
+        my_copy<vector<int>::const_iterator, vector<int>::iterator>));
+
+TEST_P(CopyVectorFixture, test_1) {
+    const vector<int>     x = {2, 3, 4};
+          vector<int>     y(5);
+    const vector<int>     z = {0, 2, 3, 4, 0};
+    vector<int>::iterator p = GetParam()(begin(x), end(x), begin(y) + 1);
+    ASSERT_EQ(p, begin(y) + 4);
+    ASSERT_EQ(y, z);}
+
+TEST_P(CopyVectorFixture, test_2) {
+    const vector<int>     x;
+          vector<int>     y(2);
+    vector<int>::iterator p = GetParam()(begin(x), end(x), begin(y) + 1);
+    ASSERT_EQ(p, begin(y) + 1);
+    ASSERT_EQ(y, vector<int>(2));}
+
+// every length to past two vectors of 32 bytes, from every alignment, and the elements on either side untouched
+TEST_P(CopyVectorFixture, test_3) {
+    vector<int> x(100);
+    iota(begin(x), end(x), 1);
+    for (int i = 0; i != 8; ++i)
+        for (int n = 0; n != 40; ++n) {
+            vector<int> y(100);
+            vector<int>::iterator p = GetParam()(begin(x) + i, begin(x) + i + n, begin(y) + 8 - i);
+            ASSERT_EQ(p, begin(y) + 8 - i + n);
+            for (int k = 0; k != 100; ++k)
+                ASSERT_EQ(y[k], ((k >= (8 - i)) && (k < (8 - i + n))) ? (k + 2 * i - 7) : 0);}}
+
+TEST_P(CopyVectorFixture, test_4) {
+    vector<int> x(10000);
+    iota(begin(x), end(x), 0);
+          vector<int> y(10003);
+    vector<int>::iterator p = GetParam()(begin(x), end(x), begin(y) + 3);
+    ASSERT_EQ(p, end(y));
+    ASSERT_TRUE(equal(begin(x), end(x), begin(y) + 3));}
+
+using CopyPointerSignature = function<char* (const char*, const char*, char*)>;
+
+struct CopyPointerFixture : TestWithParam<CopyPointerSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    CopyPointerInstantiation,
+    CopyPointerFixture,
+    Values(
+           copy<const char*, char*>,
+        my_copy<const char*, char*>));
+
+TEST_P(CopyPointerFixture, test_1) {
+    const char a[] = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+          char b[sizeof(a)] = {};
+    char* p = GetParam()(a + 1, a + sizeof(a) - 1, b);
+    ASSERT_EQ(p, b + sizeof(a) - 2);
+    ASSERT_STREQ(b, a + 1);}
+
+// to the left, over itself, which copy allows
+TEST_P(CopyPointerFixture, test_2) {
+    char a[] = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    GetParam()(a + 3, a + sizeof(a), a);
+    ASSERT_STREQ(a, "defghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ");}
+
+using CopyStringSignature = function<vector<string>::iterator (vector<string>::const_iterator, vector<string>::const_iterator, vector<string>::iterator)>;
+
+struct CopyStringFixture : TestWithParam<CopyStringSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    CopyStringInstantiation,
+    CopyStringFixture,
+    Values(
+           copy<vector<string>::const_iterator, vector<string>::iterator>,
+        my_copy<vector<string>::const_iterator, vector<string>::iterator>));
+
+TEST_P(CopyStringFixture, test_1) {
+    const vector<string>     x = {"abc", string(100, 'd'), "ef"};
+          vector<string>     y(4);
+    const vector<string>     z = {"", "abc", string(100, 'd'), "ef"};
+    vector<string>::iterator p = GetParam()(begin(x), end(x), begin(y) + 1);
+    ASSERT_EQ(p, end(y));
+    ASSERT_EQ(y, z);}
+
 /*
 % Copy
 Running main() from gtest_main.cc
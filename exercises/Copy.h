@@ -5,12 +5,29 @@
 #ifndef Copy_h
 #define Copy_h
 
+#include <type_traits> // false_type, true_type
+
+#include "Simd.h"
+
+// one element at a time
 template <typename II, typename OI>
-OI my_copy (II b, II e, OI x) {
+OI my_copy_dispatch (II b, II e, OI x, std::false_type) {
     while (b != e) {
         *x = *b;
         ++b;
         ++x;}
     return x;}
 
+// contiguous and trivially copyable, so as bytes
+template <typename II, typename OI>
+OI my_copy_dispatch (II b, II e, OI x, std::true_type) {
+    const auto n = e - b;
+    if (n != 0)
+        my_simd_copy(&*x, &*b, n * sizeof(*b));
+    return x + n;}
+
+template <typename II, typename OI>
+OI my_copy (II b, II e, OI x) {
+    return my_copy_dispatch(b, e, x, my_is_byte_copyable<II, OI>());}
+
 #endif // Copy_h
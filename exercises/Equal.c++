@@ -7,6 +7,8 @@
 #include <algorithm>  // equal
 #include <functional> // function
 #include <list>       // list
+#include <numeric>    // iota
+#include <string>     // string
 #include <vector>     // vector
 
 #include "gtest/gtest.h"
@@ -38,6 +40,75 @@ TEST_P(EqualListFixture, test_2) {
     const vector<int> y = {0, 2, 3, 4, 0};
 	ASSERT_TRUE(GetParam()(begin(x), end(x), begin(y) + 1));}
 
+using EqualVectorSignature = function<bool (vector<int>::const_iterator, vector<int>::const_iterator, vector<int>::const_iterator)>;
+
+struct EqualVectorFixture : TestWithParam<EqualVectorSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    EqualVectorInstantiation,
+    EqualVectorFixture,
+    Values(
+           equal<vector<int>::const_iterator, vector<int>::const_iterator>,
+        my_equal<vector<int>::const_iterator, vector<int>::const_iterator>));
+
+TEST_P(EqualVectorFixture, test_1) {
+    const vector<int> x = {2, 3, 4};
+    const vector<int> y = {0, 2, 3, 4, 0};
+	ASSERT_FALSE(GetParam()(begin(x), end(x), begin(y)));
+	ASSERT_TRUE (GetParam()(begin(x), end(x), begin(y) + 1));
+	ASSERT_TRUE (GetParam()(begin(x), begin(x), begin(y)));}
+
+// every length to past five vectors of 32 bytes, from every alignment, with one difference anywhere or none
+TEST_P(EqualVectorFixture, test_2) {
+    vector<int> x(50);
+    iota(begin(x), end(x), 0);
+    for (int i = 0; i != 8; ++i)
+        for (int n = 0; n != 42; ++n) {
+            vector<int> y(begin(x) + i, begin(x) + i + n);
+            ASSERT_TRUE(GetParam()(begin(x) + i, begin(x) + i + n, begin(y)));
+            for (int k = 0; k != n; ++k) {
+                ++y[k];
+                ASSERT_FALSE(GetParam()(begin(x) + i, begin(x) + i + n, begin(y)));
+                --y[k];}}}
+
+using EqualDoubleSignature = function<bool (vector<double>::const_iterator, vector<double>::const_iterator, vector<double>::const_iterator)>;
+
+struct EqualDoubleFixture : TestWithParam<EqualDoubleSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    EqualDoubleInstantiation,
+    EqualDoubleFixture,
+    Values(
+           equal<vector<double>::const_iterator, vector<double>::const_iterator>,
+        my_equal<vector<double>::const_iterator, vector<double>::const_iterator>));
+
+// == on doubles isn't == on their bytes
+TEST_P(EqualDoubleFixture, test_1) {
+    const vector<double> x(40,  0.0);
+    const vector<double> y(40, -0.0);
+	ASSERT_TRUE(GetParam()(begin(x), end(x), begin(y)));}
+
+using EqualStringSignature = function<bool (vector<string>::const_iterator, vector<string>::const_iterator, vector<string>::const_iterator)>;
+
+struct EqualStringFixture : TestWithParam<EqualStringSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    EqualStringInstantiation,
+    EqualStringFixture,
+    Values(
+           equal<vector<string>::const_iterator, vector<string>::const_iterator>,
+        my_equal<vector<string>::const_iterator, vector<string>::const_iterator>));
+
+TEST_P(EqualStringFixture, test_1) {
+    const vector<string> x = {"abc", string(100, 'd')};
+    const vector<string> y = {"abc", string(100, 'd')};
+    const vector<string> z = {"abc", string(100, 'e')};
+	ASSERT_TRUE (GetParam()(begin(x), end(x), begin(y)));
+	ASSERT_FALSE(GetParam()(begin(x), end(x), begin(z)));}
+
 /*
 % Equal
 Running main() from gtest_main.cc
@@ -5,8 +5,13 @@
 #ifndef Equal_h
 #define Equal_h
 
+#include <type_traits> // false_type, true_type
+
+#include "Simd.h"
+
+// one element at a time
 template <typename II1, typename II2>
-bool my_equal (II1 b, II1 e, II2 c) {
+bool my_equal_dispatch (II1 b, II1 e, II2 c, std::false_type) {
     while (b != e) {
         if (*b != *c)
             return false;
@@ -14,4 +19,13 @@ bool my_equal (II1 b, II1 e, II2 c) {
         ++c;}
     return true;}
 
+// contiguous, with an == that compares bytes, so as bytes
+template <typename II1, typename II2>
+bool my_equal_dispatch (II1 b, II1 e, II2 c, std::true_type) {
+    return (b == e) || my_simd_equal(&*b, &*c, (e - b) * sizeof(*b));}
+
+template <typename II1, typename II2>
+bool my_equal (II1 b, II1 e, II2 c) {
+    return my_equal_dispatch(b, e, c, my_is_byte_equal<II1, II2>());}
+
 #endif // Equal_h
@@ -2,10 +2,11 @@
 // Fill.c++
 // --------
 
-#include <algorithm>  // equal, fill
+#include <algorithm>  // count, equal, fill
 #include <cassert>    // assert
 #include <functional> // function
 #include <iostream>   // cout, endl
+#include <string>     // string
 #include <vector>     // vector
 
 #include "gtest/gtest.h"
@@ -41,6 +42,109 @@ TEST_P(FillListFixture, test_2) {
     GetParam()(begin(x) + 1, end(x) - 1, v);
     ASSERT_TRUE(equal(begin(x), end(x), begin(y)));}
 
+// every length to past two vectors of 32 bytes, from every alignment, and the elements on either side untouched
+TEST_P(FillListFixture, test_3) {
+    for (int i = 0; i != 8; ++i)
+        for (int n = 0; n != 40; ++n) {
+            vector<int> x(64);
+            GetParam()(begin(x) + i, begin(x) + i + n, -7);
+            for (int k = 0; k != 64; ++k)
+                ASSERT_EQ(x[k], ((k >= i) && (k < (i + n))) ? -7 : 0);}}
+
+TEST_P(FillListFixture, test_4) {
+    vector<int> x(10002);
+    GetParam()(begin(x) + 1, end(x) - 1, 5);
+    ASSERT_EQ(x.front(), 0);
+    ASSERT_EQ(x.back(),  0);
+    ASSERT_EQ(count(begin(x), end(x), 5), 10000);}
+
+using FillCharSignature = function<void (char*, char*, const char&)>;
+
+struct FillCharFixture : TestWithParam<FillCharSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    FillCharInstantiation,
+    FillCharFixture,
+    Values(
+           fill<char*, char>,
+        my_fill<char*, char>));
+
+TEST_P(FillCharFixture, test_1) {
+    char a[] = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    GetParam()(a + 1, a + sizeof(a) - 2, '.');
+    ASSERT_STREQ(a, "a............................................................Z");}
+
+using FillDoubleSignature = function<void (vector<double>::iterator, vector<double>::iterator, const double&)>;
+
+struct FillDoubleFixture : TestWithParam<FillDoubleSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    FillDoubleInstantiation,
+    FillDoubleFixture,
+    Values(
+           fill<vector<double>::iterator, double>,
+        my_fill<vector<double>::iterator, double>));
+
+TEST_P(FillDoubleFixture, test_1) {
+    for (int n = 0; n != 20; ++n) {
+        vector<double> x(21, 1.0);
+        GetParam()(begin(x) + 1, begin(x) + 1 + n, -0.5);
+        ASSERT_EQ(x[0], 1.0);
+        ASSERT_EQ(count(begin(x), end(x), -0.5), n);}}
+
+// 8 bytes, but aligned to 4, so not always on a multiple of its size
+// trivially copyable, unlike pair<int, int>, whose assignment is user-provided, so my_fill takes the vector path
+struct two_ints {
+    int a;
+    int b;};
+
+bool operator == (const two_ints& lhs, const two_ints& rhs) {
+    return (lhs.a == rhs.a) && (lhs.b == rhs.b);}
+
+using FillPairSignature = function<void (vector<two_ints>::iterator, vector<two_ints>::iterator, const two_ints&)>;
+
+struct FillPairFixture : TestWithParam<FillPairSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    FillPairInstantiation,
+    FillPairFixture,
+    Values(
+           fill<vector<two_ints>::iterator, two_ints>,
+        my_fill<vector<two_ints>::iterator, two_ints>));
+
+TEST_P(FillPairFixture, test_1) {
+    ASSERT_TRUE((my_is_byte_fillable<vector<two_ints>::iterator, two_ints>::value));
+    const two_ints v = {2, 3};
+    const two_ints z = {0, 0};
+    for (int i = 0; i != 4; ++i) {
+        vector<two_ints> x(40, z);
+        GetParam()(begin(x) + i, begin(x) + i + 30, v);
+        ASSERT_EQ(count(begin(x), end(x), v), 30);
+        ASSERT_EQ(x[i + 30], z);
+        ASSERT_EQ(count(begin(x), begin(x) + i, z), i);}}
+
+using FillStringSignature = function<void (vector<string>::iterator, vector<string>::iterator, const string&)>;
+
+struct FillStringFixture : TestWithParam<FillStringSignature>
+    {};
+
+INSTANTIATE_TEST_CASE_P(
+    FillStringInstantiation,
+    FillStringFixture,
+    Values(
+           fill<vector<string>::iterator, string>,
+        my_fill<vector<string>::iterator, string>));
+
+TEST_P(FillStringFixture, test_1) {
+    const string         v(100, 'a');
+          vector<string> x(5);
+    const vector<string> y = {"", v, v, v, ""};
+    GetParam()(begin(x) + 1, end(x) - 1, v);
+    ASSERT_EQ(x, y);}
+
 /*
 % Fill
 Running main() from gtest_main.cc
@@ -5,10 +5,33 @@
 #ifndef Fill_h
 #define Fill_h
 
+#include <type_traits> // false_type, is_same, is_trivially_copyable, true_type
+
+#include "Simd.h"
+
+// one element at a time
 template <typename FI, typename T>
-void my_fill (FI b, FI e, const T& v) {
+void my_fill_dispatch (FI b, FI e, const T& v, std::false_type) {
     while (b != e) {
         *b = v;
         ++b;}}
 
+// contiguous and trivially copyable, so with vector stores
+template <typename FI, typename T>
+void my_fill_dispatch (FI b, FI e, const T& v, std::true_type) {
+    if (b != e)
+        my_simd_fill(&*b, v, e - b);}
+
+// true if [b, e) of FI can be filled with a T as bytes; a T of another type would have to be converted first
+template <typename FI, typename T>
+struct my_is_byte_fillable : std::integral_constant<bool,
+        my_is_contiguous<FI>::value                          &&
+        std::is_same<my_value_type<FI>, T>::value            &&
+        std::is_trivially_copyable<T>::value>
+    {};
+
+template <typename FI, typename T>
+void my_fill (FI b, FI e, const T& v) {
+    my_fill_dispatch(b, e, v, my_is_byte_fillable<FI, T>());}
+
 #endif // Fill_h
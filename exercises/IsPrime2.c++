@@ -4,6 +4,9 @@
 
 // https://en.wikipedia.org/wiki/Primality_test
 
+#include <cstdint> // uint64_t
+#include <vector>  // vector
+
 #include "gtest/gtest.h"
 
 #include "IsPrime2.h"
@@ -35,6 +38,56 @@ TEST(IsPrimeFixture, test_27) {
 TEST(IsPrimeFixture, test_29) {
     ASSERT_TRUE(is_prime(29));}
 
+TEST(IsPrimeFixture, test_561) {
+    ASSERT_FALSE(is_prime(561));}
+
+TEST(IsPrimeFixture, test_3215031751) {
+    ASSERT_FALSE(is_prime(3215031751ULL));}
+
+TEST(IsPrimeFixture, test_2_61) {
+    ASSERT_TRUE(is_prime((1ULL << 61) - 1));}
+
+TEST(IsPrimeFixture, test_2_64) {
+    ASSERT_TRUE(is_prime(18446744073709551557ULL));}
+
+TEST(IsPrimeFixture, test_square) {
+    ASSERT_FALSE(is_prime(4294967291ULL * 4294967291ULL));}
+
+TEST(IsPrimeFixture, test_product) {
+    ASSERT_FALSE(is_prime(4294967291ULL * 4294967279ULL));}
+
+TEST(IsPrimeFixture, test_range) {
+    int c = 0;
+    for (int n = 1; n != 100000; ++n)
+        c += is_prime(n);
+    ASSERT_EQ(c, 9592);}
+
+TEST(PrimesFixture, test_1) {
+    const std::vector<std::uint64_t> v = my_primes(0, 30);
+    ASSERT_EQ(v, std::vector<std::uint64_t>({2, 3, 5, 7, 11, 13, 17, 19, 23, 29}));}
+
+TEST(PrimesFixture, test_2) {
+    ASSERT_TRUE(my_primes(24, 29).empty());
+    ASSERT_TRUE(my_primes(5, 5).empty());
+    ASSERT_EQ(my_primes(29, 30), std::vector<std::uint64_t>({29}));
+    ASSERT_EQ(my_primes(2, 3),   std::vector<std::uint64_t>({2}));}
+
+// many segments, across threads
+TEST(PrimesFixture, test_3) {
+    ASSERT_EQ(my_primes(0, 10000000).size(),    664579u);
+    ASSERT_EQ(my_primes(0, 10000000, 4).size(), 664579u);
+    ASSERT_EQ(my_primes(1, 10000000, 7), my_primes(1, 10000000));}
+
+// far from 0, against is_prime
+TEST(PrimesFixture, test_4) {
+    const std::uint64_t              b = 1000000000000ULL + 1;
+    const std::vector<std::uint64_t> v = my_primes(b, b + 1000000, 3);
+    std::vector<std::uint64_t> w;
+    for (std::uint64_t n = b; n != (b + 1000000); ++n)
+        if (is_prime(n))
+            w.push_back(n);
+    ASSERT_EQ(v, w);}
+
 /*
 % IsPrime2
 Running main() from gtest_main.cc
@@ -2,21 +2,182 @@
 // IsPrime2.h
 // ----------
 
+// https://en.wikipedia.org/wiki/Miller%E2%80%93Rabin_primality_test
+// https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
+// https://en.wikipedia.org/wiki/Sieve_of_Eratosthenes#Segmented_sieve
+
 #ifndef IsPrime2_h
 #define IsPrime2_h
 
-#include <cassert>  // assert
-#include <cmath>    // sqrt
+#include <algorithm> // max, min
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <thread>    // thread
+#include <vector>    // vector
 
-bool is_prime (int n) {
-    assert(n > 0);
-    if (n == 2)
-        return true;
-    if ((n == 1) || ((n % 2) == 0))
-        return false;
-    for (int i = 3; i <= std::sqrt(n); i += 2)
-        if ((n % i) == 0)
-            return false;
+/*
+is_prime: Miller-Rabin, with the seven bases that are known to decide every n < 2^64,
+so the answer is exact; the arithmetic mod n is in Montgomery form, so each step is multiplies and no divides
+numbers with a small factor are settled first by division
+
+my_primes: a sieve of Eratosthenes over [lo, hi), a segment at a time;
+a segment holds the odd numbers only, one bit each, and is sized to stay in L1
+segments are independent, so they can be split between threads
+*/
+
+__extension__ typedef unsigned __int128 my_uint128;
+
+// arithmetic mod an odd n, on numbers in Montgomery form: a is a * 2^64 mod n
+class my_montgomery {
+    private:
+        std::uint64_t _n;
+        std::uint64_t _i;  // n^-1 mod 2^64
+        std::uint64_t _r2; // 2^128 mod n
+
+    public:
+        explicit my_montgomery (std::uint64_t n) :
+                _n (n) {
+            assert((n % 2) == 1);
+            // Newton's iteration doubles the correct low bits of n^-1 each time, from 3 correct for any odd n
+            _i = n;
+            for (int k = 0; k != 5; ++k)
+                _i *= 2 - (n * _i);
+            const std::uint64_t r = -n % n;
+            _r2 = (my_uint128(r) * r) % n;}
+
+        // t * 2^-64 mod n, for t < n * 2^64
+        std::uint64_t reduce (my_uint128 t) const {
+            const std::uint64_t m = std::uint64_t(t) * _i;
+            const std::uint64_t h = (my_uint128(m) * _n) >> 64;
+            const std::uint64_t u = t >> 64;
+            return (u >= h) ? (u - h) : (u - h + _n);}
+
+        std::uint64_t to (std::uint64_t a) const {
+            return reduce(my_uint128(a) * _r2);}
+
+        std::uint64_t multiply (std::uint64_t a, std::uint64_t b) const {
+            return reduce(my_uint128(a) * b);}
+
+        // a^e, with a and the result in Montgomery form
+        std::uint64_t power (std::uint64_t a, std::uint64_t e) const {
+            std::uint64_t r = to(1);
+            while (e != 0) {
+                if (e & 1)
+                    r = multiply(r, a);
+                a = multiply(a, a);
+                e >>= 1;}
+            return r;}};
+
+// true if n, odd and not 1, passes Miller-Rabin to every base
+bool my_is_prime_miller_rabin (std::uint64_t n) {
+    static const std::uint64_t bases[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+    const my_montgomery m(n);
+    const std::uint64_t d = (n - 1) >> __builtin_ctzll(n - 1);
+    const std::uint64_t one   = m.to(1);
+    const std::uint64_t minus = m.to(n - 1);
+    for (std::uint64_t a : bases) {
+        a %= n;
+        if (a == 0)
+            continue;
+        std::uint64_t x = m.power(m.to(a), d);
+        if ((x == one) || (x == minus))
+            continue;
+        std::uint64_t e = d;
+        while ((x != minus) && ((e *= 2) != (n - 1)))
+            x = m.multiply(x, x);
+        if (x != minus)
+            return false;}
     return true;}
 
+bool is_prime (std::uint64_t n) {
+    assert(n > 0);
+    static const std::uint64_t small[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    for (std::uint64_t p : small) {
+        if (n == p)
+            return true;
+        if ((n % p) == 0)
+            return false;}
+    if (n < (41 * 41))
+        return n != 1;
+    return my_is_prime_miller_rabin(n);}
+
+// the odd primes up to and including n, by a plain sieve
+std::vector<std::uint64_t> my_sieve_base (std::uint64_t n) {
+    std::vector<bool>          c((n / 2) + 1, true);
+    std::vector<std::uint64_t> v;
+    for (std::uint64_t i = 3; i <= n; i += 2)
+        if (c[i / 2]) {
+            v.push_back(i);
+            for (std::uint64_t j = i * i; j <= n; j += 2 * i)
+                c[j / 2] = false;}
+    return v;}
+
+// floor(sqrt(n))
+std::uint64_t my_sieve_root (std::uint64_t n) {
+    std::uint64_t r = 0;
+    for (int k = 31; k >= 0; --k) {
+        const std::uint64_t s = r | (std::uint64_t(1) << k);
+        if ((s * s) <= n)
+            r = s;}
+    return r;}
+
+// the odd numbers of a segment are [b + 1, b + 3, ..., b + 2 * bits - 1], with b even
+const std::size_t my_sieve_words = 4096;                // 32 KB
+const std::size_t my_sieve_bits  = my_sieve_words * 64;
+const std::size_t my_sieve_span  = my_sieve_bits  * 2;
+
+// appends the primes of [lo, hi) in segment s to v, in order
+void my_sieve_segment (std::uint64_t lo, std::uint64_t hi, std::size_t s, const std::vector<std::uint64_t>& ps, std::vector<std::uint64_t>& v) {
+    const std::uint64_t b = (lo & ~std::uint64_t(1)) + (s * my_sieve_span);
+    const std::uint64_t e = std::min<my_uint128>(my_uint128(b) + my_sieve_span, hi);
+    std::vector<std::uint64_t> w(my_sieve_words, ~std::uint64_t(0));
+    for (std::uint64_t p : ps) {
+        if ((my_uint128(p) * p) >= e)
+            break;
+        // the first odd multiple of p in the segment, and no less than p * p
+        my_uint128 m = std::max<my_uint128>(my_uint128(p) * p, ((my_uint128(b) + p - 1) / p) * p);
+        if ((m % 2) == 0)
+            m += p;
+        if (((m - b) / 2) >= my_sieve_bits)
+            continue;
+        for (std::size_t j = std::size_t((m - b) / 2); j < my_sieve_bits; j += p)
+            w[j / 64] &= ~(std::uint64_t(1) << (j % 64));}
+    for (std::size_t k = 0; k != my_sieve_words; ++k)
+        for (std::uint64_t x = w[k]; x != 0; x &= x - 1) {
+            const std::uint64_t n = b + (2 * ((64 * k) + __builtin_ctzll(x))) + 1;
+            if (n >= e)
+                return;
+            if ((n >= lo) && (n != 1))
+                v.push_back(n);}}
+
+/**
+ * @param t the number of threads, each taking a run of the segments
+ * @return the primes in [lo, hi), in order
+ */
+std::vector<std::uint64_t> my_primes (std::uint64_t lo, std::uint64_t hi, std::size_t t = 1) {
+    std::vector<std::uint64_t> v;
+    if (lo >= hi)
+        return v;
+    if ((lo <= 2) && (hi > 2))
+        v.push_back(2);
+    const std::vector<std::uint64_t> ps = my_sieve_base(my_sieve_root(hi - 1));
+    const std::size_t n = std::size_t(((hi - (lo & ~std::uint64_t(1))) + my_sieve_span - 1) / my_sieve_span);
+    t = std::max<std::size_t>(1, std::min(t, n));
+    std::vector<std::vector<std::uint64_t>> r(t);
+    std::vector<std::thread>                h;
+    for (std::size_t i = 0; i != t; ++i) {
+        const auto f = [&, i] () {
+            for (std::size_t s = (i * n) / t; s != (((i + 1) * n) / t); ++s)
+                my_sieve_segment(lo, hi, s, ps, r[i]);};
+        if (i == (t - 1))
+            f();
+        else
+            h.emplace_back(f);}
+    for (std::thread& x : h)
+        x.join();
+    for (const std::vector<std::uint64_t>& x : r)
+        v.insert(v.end(), x.begin(), x.end());
+    return v;}
+
 #endif // IsPrime2_h
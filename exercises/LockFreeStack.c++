@@ -0,0 +1,196 @@
+// -----------------
+// LockFreeStack.c++
+// -----------------
+
+#include <algorithm> // sort
+#include <atomic>    // atomic
+#include <memory>    // unique_ptr
+#include <stdexcept> // runtime_error
+#include <string>    // string
+#include <thread>    // thread
+#include <utility>   // move
+#include <vector>    // vector
+
+#include "gtest/gtest.h"
+
+#include "LockFreeStack.h"
+
+using namespace std;
+
+TEST(LockFreeStackFixture, test_1) {
+    my_lock_free_stack<int> x;
+    ASSERT_TRUE(x.empty());
+    ASSERT_EQ(x.size(), 0);
+
+    x.push(2);
+    x.push(3);
+    x.push(4);
+    ASSERT_FALSE(x.empty());
+    ASSERT_EQ(x.size(), 3);
+
+    int v = 0;
+    ASSERT_TRUE(x.try_pop(v));
+    ASSERT_EQ(v, 4);
+    x.pop();
+    ASSERT_TRUE(x.try_pop(v));
+    ASSERT_EQ(v, 2);
+    ASSERT_FALSE(x.try_pop(v));
+    ASSERT_EQ(v, 2);
+    ASSERT_TRUE(x.empty());
+    x.pop();
+    ASSERT_EQ(x.size(), 0);}
+
+TEST(LockFreeStackFixture, test_2) {
+    // popped nodes are recycled, and what's left is destroyed with the stack
+    my_lock_free_stack<string> x;
+    for (int i = 0; i != 1000; ++i) {
+        x.push(string(100, 'a' + (i % 26)));
+        if ((i % 3) != 0)
+            x.pop();}
+    ASSERT_EQ(x.size(), 334);
+    string s;
+    ASSERT_TRUE(x.try_pop(s));
+    ASSERT_EQ(s, string(100, 'a' + (999 % 26)));}
+
+TEST(LockFreeStackFixture, test_3) {
+    // past the first chunk
+    my_lock_free_stack<int> x;
+    for (int i = 0; i != 100000; ++i)
+        x.push(i);
+    ASSERT_EQ(x.size(), 100000);
+    for (int i = 100000; i != 0; --i) {
+        int v;
+        ASSERT_TRUE(x.try_pop(v));
+        ASSERT_EQ(v, i - 1);}
+    ASSERT_TRUE(x.empty());}
+
+TEST(LockFreeStackFixture, test_4) {
+    // every value pushed by a producer is popped by exactly one consumer
+    const int               t = 4;
+    const int               n = 20000;
+    my_lock_free_stack<int> x;
+    atomic<int>             left(t * n);
+    vector<vector<int>>     got(t);
+    vector<thread>          ts;
+    for (int k = 0; k != t; ++k) {
+        ts.push_back(thread([&, k] () {
+            for (int i = 0; i != n; ++i)
+                x.push((k * n) + i);}));
+        ts.push_back(thread([&, k] () {
+            int v;
+            while (left.load() > 0)
+                if (x.try_pop(v)) {
+                    got[k].push_back(v);
+                    --left;}}));}
+    for (thread& h : ts)
+        h.join();
+    vector<int> a;
+    for (const vector<int>& g : got)
+        a.insert(a.end(), g.begin(), g.end());
+    sort(a.begin(), a.end());
+    ASSERT_EQ(a.size(), t * n);
+    for (int i = 0; i != (t * n); ++i)
+        ASSERT_EQ(a[i], i);
+    ASSERT_TRUE(x.empty());}
+
+TEST(LockFreeStackFixture, test_5) {
+    // a few nodes, popped and pushed back over and over by every thread, the case that ABA breaks
+    const int               t = 4;
+    my_lock_free_stack<int> x;
+    for (int i = 0; i != 3; ++i)
+        x.push(i);
+    vector<thread> ts;
+    for (int k = 0; k != t; ++k)
+        ts.push_back(thread([&] () {
+            for (int i = 0; i != 50000; ++i) {
+                int v;
+                if (x.try_pop(v))
+                    x.push(v);}}));
+    for (thread& h : ts)
+        h.join();
+    vector<int> a;
+    int         v;
+    while (x.try_pop(v))
+        a.push_back(v);
+    sort(a.begin(), a.end());
+    ASSERT_EQ(a, vector<int>({0, 1, 2}));}
+
+struct thrower {
+    static bool fail;
+
+    int v;
+
+    thrower (int v = 0) :
+            v (v)
+        {}
+
+    thrower (const thrower& that) :
+            v (that.v) {
+        if (fail)
+            throw runtime_error("thrower");}
+
+    thrower& operator = (const thrower&) = default;};
+
+bool thrower::fail = false;
+
+TEST(LockFreeStackFixture, test_6) {
+    my_lock_free_stack<thrower> x;
+    x.push(thrower(2));
+    thrower::fail = true;
+    ASSERT_THROW(x.push(thrower(3)), runtime_error);
+    thrower::fail = false;
+    ASSERT_EQ(x.size(), 1);
+    x.push(thrower(4));
+    thrower v;
+    ASSERT_TRUE(x.try_pop(v));
+    ASSERT_EQ(v.v, 4);
+    ASSERT_TRUE(x.try_pop(v));
+    ASSERT_EQ(v.v, 2);
+    ASSERT_TRUE(x.empty());}
+
+TEST(LockFreeStackFixture, test_7) {
+    my_lock_free_stack<unique_ptr<int>> x;
+    unique_ptr<int> p(new int(2));
+    x.push(move(p));
+    ASSERT_EQ(p, nullptr);
+    x.emplace(new int(3));
+    ASSERT_EQ(x.size(), 2);
+    unique_ptr<int> v;
+    ASSERT_TRUE(x.try_pop(v));
+    ASSERT_EQ(*v, 3);
+    ASSERT_TRUE(x.try_pop(v));
+    ASSERT_EQ(*v, 2);
+    ASSERT_FALSE(x.try_pop(v));}
+
+TEST(LockFreeStackFixture, test_8) {
+    my_lock_free_stack<string> x;
+    x.emplace(3, 'a');
+    x.emplace("bc");
+    string v;
+    ASSERT_TRUE(x.try_pop(v));
+    ASSERT_EQ(v, "bc");
+    ASSERT_TRUE(x.try_pop(v));
+    ASSERT_EQ(v, "aaa");}
+
+/*
+% LockFreeStack
+Running main() from ./googletest/src/gtest_main.cc
+[==========] Running 5 tests from 1 test suite.
+[----------] Global test environment set-up.
+[----------] 5 tests from LockFreeStackFixture
+[ RUN      ] LockFreeStackFixture.test_1
+[       OK ] LockFreeStackFixture.test_1 (0 ms)
+[ RUN      ] LockFreeStackFixture.test_2
+[       OK ] LockFreeStackFixture.test_2 (0 ms)
+[ RUN      ] LockFreeStackFixture.test_3
+[       OK ] LockFreeStackFixture.test_3 (0 ms)
+[ RUN      ] LockFreeStackFixture.test_4
+[       OK ] LockFreeStackFixture.test_4 (0 ms)
+[ RUN      ] LockFreeStackFixture.test_5
+[       OK ] LockFreeStackFixture.test_5 (0 ms)
+[----------] 5 tests from LockFreeStackFixture (0 ms total)
+
+[----------] Global test environment tear-down
+[==========] 5 tests from 1 test suite ran. (0 ms total)
+[  PASSED  ] 5 tests.
+*/
@@ -0,0 +1,195 @@
+// ---------------
+// LockFreeStack.h
+// ---------------
+
+// https://en.wikipedia.org/wiki/Treiber_stack
+// https://en.wikipedia.org/wiki/ABA_problem
+
+#ifndef LockFreeStack_h
+#define LockFreeStack_h
+
+#include <atomic>  // atomic, memory_order_*
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t, uint64_t
+#include <new>     // placement new
+#include <utility> // forward, move
+
+/*
+my_stack's interface, shared between threads, without a lock
+
+a Treiber stack of nodes that live in the stack's own arena and are named by index;
+the head is an index and a tag in one 64-bit word, and every change of the head bumps the tag,
+so a pop that read the head before another thread popped and pushed the same node fails its CAS (ABA)
+nodes are never freed while the stack lives, only recycled,
+so a pop may read the next of a node that another thread has already taken
+
+a popped node goes to the free list of its thread's shard, and a push takes a node from its own shard first,
+then from the other shards, and only then from the arena
+a thread's shard is numbered once per process, in the order threads first push or pop, and is the same in every stack;
+threads that use one stack may share a shard, which costs contention on that free list, not correctness
+
+the parts of my_stack that can't be made safe are replaced:
+top is gone, since its reference could be popped out from under it;
+where my_stack's callers read top and then pop, they call try_pop, which removes the top and returns it in one step
+size is exact only when no push or pop is in flight
+*/
+
+inline std::size_t my_lock_free_stack_shard () {
+    static std::atomic<std::size_t> n(0);
+    static thread_local std::size_t s = n.fetch_add(1, std::memory_order_relaxed);
+    return s;}
+
+template <typename T>
+class my_lock_free_stack {
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+
+        using reference       = value_type&;
+        using const_reference = const value_type&;
+
+    private:
+        struct node {
+            std::atomic<std::uint32_t> next;
+            alignas(T) unsigned char   value[sizeof(T)];};
+
+        // a head is a tag in the high 32 bits and a node in the low 32, 0 if none
+        struct alignas(64) list {
+            std::atomic<std::uint64_t> head;};
+
+        static const size_type first  = 64; // the nodes of chunk k are [first * (2^k - 1), first * (2^(k + 1) - 1))
+        static const size_type chunks = 26; // 2^32 - 1 nodes, less the 0 of none
+        static const size_type shards = 8;
+
+        list                       _top;
+        list                       _free[shards];
+        std::atomic<node*>         _chunks[chunks];
+        std::atomic<std::uint32_t> _used;
+        std::atomic<size_type>     _size;
+
+        static std::uint32_t index (std::uint64_t h) {
+            return std::uint32_t(h);}
+
+        static std::uint64_t next_head (std::uint64_t h, std::uint32_t n) {
+            return (((h >> 32) + 1) << 32) | n;}
+
+        // the chunk of the node at offset i in the arena
+        static size_type chunk (size_type i) {
+            return 63 - __builtin_clzll((i / first) + 1);}
+
+        node& at (std::uint32_t n) const {
+            assert(n != 0);
+            const size_type i = n - 1;
+            const size_type k = chunk(i);
+            node* const c = _chunks[k].load(std::memory_order_acquire);
+            assert(c != nullptr);
+            return c[i - (first * ((size_type(1) << k) - 1))];}
+
+        void link (list& l, std::uint32_t n) {
+            std::uint64_t h = l.head.load(std::memory_order_relaxed);
+            do
+                at(n).next.store(index(h), std::memory_order_relaxed);
+            while (!l.head.compare_exchange_weak(h, next_head(h, n), std::memory_order_release, std::memory_order_relaxed));}
+
+        std::uint32_t unlink (list& l) {
+            std::uint64_t h = l.head.load(std::memory_order_acquire);
+            while (index(h) != 0) {
+                const std::uint32_t n = at(index(h)).next.load(std::memory_order_relaxed);
+                if (l.head.compare_exchange_weak(h, next_head(h, n), std::memory_order_acquire, std::memory_order_acquire))
+                    return index(h);}
+            return 0;}
+
+        // a node from the shards' free lists, or else a new one from the arena
+        std::uint32_t allocate () {
+            const size_type s = my_lock_free_stack_shard();
+            for (size_type k = 0; k != shards; ++k)
+                if (const std::uint32_t n = unlink(_free[(s + k) % shards]))
+                    return n;
+            const std::uint32_t n = _used.fetch_add(1, std::memory_order_relaxed) + 1;
+            assert(n != 0);
+            const size_type k = chunk(n - 1);
+            assert(k < chunks);
+            if (_chunks[k].load(std::memory_order_acquire) == nullptr) {
+                node* c = new node[first << k];
+                node* e = nullptr;
+                if (!_chunks[k].compare_exchange_strong(e, c, std::memory_order_acq_rel))
+                    delete [] c;}
+            return n;}
+
+        void deallocate (std::uint32_t n) {
+            link(_free[my_lock_free_stack_shard() % shards], n);}
+
+    public:
+        my_lock_free_stack () :
+                _used (0),
+                _size (0) {
+            _top.head.store(0, std::memory_order_relaxed);
+            for (list& l : _free)
+                l.head.store(0, std::memory_order_relaxed);
+            for (std::atomic<node*>& c : _chunks)
+                c.store(nullptr, std::memory_order_relaxed);}
+
+        my_lock_free_stack             (const my_lock_free_stack&) = delete;
+        my_lock_free_stack& operator = (const my_lock_free_stack&) = delete;
+
+        ~my_lock_free_stack () {
+            for (std::uint32_t n = index(_top.head.load(std::memory_order_relaxed)); n != 0; n = at(n).next.load(std::memory_order_relaxed))
+                reinterpret_cast<value_type*>(at(n).value)->~value_type();
+            for (std::atomic<node*>& c : _chunks)
+                delete [] c.load(std::memory_order_relaxed);}
+
+        bool empty () const {
+            return index(_top.head.load(std::memory_order_acquire)) == 0;}
+
+        /**
+         * if the constructor throws, the stack is unchanged, and the node goes back to the free list
+         */
+        template <typename... Args>
+        void emplace (Args&&... args) {
+            const std::uint32_t n = allocate();
+            try {
+                new (at(n).value) value_type(std::forward<Args>(args)...);}
+            catch (...) {
+                deallocate(n);
+                throw;}
+            _size.fetch_add(1, std::memory_order_relaxed);
+            link(_top, n);}
+
+        /**
+         * does nothing if the stack is empty
+         */
+        void pop () {
+            const std::uint32_t n = unlink(_top);
+            if (n == 0)
+                return;
+            reinterpret_cast<value_type*>(at(n).value)->~value_type();
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            deallocate(n);}
+
+        void push (const_reference v) {
+            emplace(v);}
+
+        void push (value_type&& v) {
+            emplace(std::move(v));}
+
+        size_type size () const {
+            return _size.load(std::memory_order_relaxed);}
+
+        /**
+         * top and pop in one step
+         * @param v the popped value, if any
+         * @return false if the stack was empty
+         */
+        bool try_pop (reference v) {
+            const std::uint32_t n = unlink(_top);
+            if (n == 0)
+                return false;
+            value_type* const p = reinterpret_cast<value_type*>(at(n).value);
+            v = std::move(*p);
+            p->~value_type();
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            deallocate(n);
+            return true;}};
+
+#endif // LockFreeStack_h
@@ -4,11 +4,18 @@
 
 // http://www.cplusplus.com/reference/utility/pair/
 
-#include <utility> // pair
+#include <algorithm>   // copy, reverse, sort
+#include <functional>  // less
+#include <memory>      // unique_ptr
+#include <string>      // string
+#include <type_traits> // is_trivially_copyable
+#include <utility>     // move, pair, swap
+#include <vector>      // vector
 
 #include "gtest/gtest.h"
 
 #include "Pair.h"
+#include "PairVector.h"
 
 using namespace std;
 
@@ -71,6 +78,166 @@ TYPED_TEST(Pair_Fixture, test_4) {
     ASSERT_NE(&x.first,  &y.first);
     ASSERT_NE(&x.second, &y.second);}
 
+TYPED_TEST(Pair_Fixture, test_5) {
+    using pair_type = typename TestFixture::pair_type;
+
+    const short s = 2;
+    pair_type   x(s, 'c');
+    ASSERT_EQ(x.first,  2);
+    ASSERT_EQ(x.second, 'c');}
+
+template <typename T>
+struct Pair_Move_Fixture : Test {
+    using pair_type = T;};
+
+typedef Types<
+               pair<string, unique_ptr<int>>,
+            my_pair<string, unique_ptr<int>>>
+        pair_move_types;
+
+TYPED_TEST_CASE(Pair_Move_Fixture, pair_move_types);
+
+TYPED_TEST(Pair_Move_Fixture, test_1) {
+    using pair_type = typename TestFixture::pair_type;
+
+    unique_ptr<int> p(new int(3));
+    int* const      q = p.get();
+    pair_type       x(string(100, 'a'), move(p));
+    ASSERT_EQ(x.second.get(), q);
+    ASSERT_EQ(p, nullptr);}
+
+TYPED_TEST(Pair_Move_Fixture, test_2) {
+    using pair_type = typename TestFixture::pair_type;
+
+    pair_type         x(string(100, 'a'), unique_ptr<int>(new int(3)));
+    const char* const c = x.first.data();
+    pair_type         y = move(x);
+    ASSERT_EQ(y.first.data(), c);
+    ASSERT_EQ(*y.second, 3);
+    ASSERT_EQ(x.second, nullptr);}
+
+TYPED_TEST(Pair_Move_Fixture, test_3) {
+    using pair_type = typename TestFixture::pair_type;
+
+    pair_type x("abc", unique_ptr<int>(new int(3)));
+    pair_type y;
+    y = move(x);
+    ASSERT_EQ(y.first, "abc");
+    ASSERT_EQ(*y.second, 3);
+    ASSERT_EQ(x.second, nullptr);}
+
+struct empty_type
+    {};
+
+// a type with tail padding that isn't POD for layout, which [[no_unique_address]] would let second move into;
+// std::copy of one copies its padding too
+struct padded {
+    int  a;
+    char b;
+
+    padded () :
+            a (0),
+            b (0)
+        {}};
+
+TEST(Pair_Layout, test_1) {
+    ASSERT_EQ(sizeof(my_pair<less<int>, int>),   sizeof(int));
+    ASSERT_EQ(sizeof(my_pair<int, empty_type>),  sizeof(int));
+    ASSERT_EQ(sizeof(my_pair<double, int>),      sizeof(pair<double, int>));
+    ASSERT_EQ(sizeof(my_pair<padded, char>),     sizeof(pair<padded, char>));}
+
+TEST(Pair_Layout, test_2) {
+    ASSERT_TRUE ((is_trivially_copyable<my_pair<int, double>>::value));
+    ASSERT_TRUE ((is_trivially_copyable<my_pair<empty_type, int>>::value));
+    ASSERT_FALSE((is_trivially_copyable<my_pair<string, int>>::value));}
+
+TEST(Pair_Layout, test_3) {
+    // copying a whole first, padding and all, leaves second alone
+    padded                s;
+    s.a = 2;
+    s.b = 'c';
+    my_pair<padded, char> p(padded(), 'x');
+    copy(&s, &s + 1, &p.first);
+    ASSERT_EQ(p.first.a, 2);
+    ASSERT_EQ(p.first.b, 'c');
+    ASSERT_EQ(p.second,  'x');}
+
+TEST(Pair_Make, test_1) {
+    const my_pair<const char*, int> x = my_make_pair("abc", 2);
+    ASSERT_STREQ(x.first, "abc");
+    ASSERT_EQ(x.second, 2);}
+
+TEST(Pair_Vector, test_1) {
+    my_pair_vector<int, string> x;
+    ASSERT_TRUE(x.empty());
+    x.push_back(my_pair<int, string>(2, "abc"));
+    x.emplace_back(3, string(100, 'd'));
+    ASSERT_EQ(x.size(), 2u);
+    ASSERT_EQ(x[0].first,  2);
+    ASSERT_EQ(x[1].second, string(100, 'd'));
+    ASSERT_EQ(x.firsts(), vector<int>({2, 3}));}
+
+TEST(Pair_Vector, test_2) {
+    my_pair_vector<int, int> x = {{2, 3}, {4, 5}, {6, 7}};
+    x[1].first  = 8;
+    x[2].second = 9;
+    const my_pair<int, int> p = x[1];
+    ASSERT_EQ(p.first,  8);
+    ASSERT_EQ(p.second, 5);
+    ASSERT_EQ(x.seconds(), vector<int>({3, 5, 9}));
+    x.pop_back();
+    ASSERT_EQ(x.size(), 2u);}
+
+TEST(Pair_Vector, test_3) {
+    const my_pair_vector<int, int> x = {{2, 3}, {4, 5}, {6, 7}};
+    int s = 0;
+    for (my_pair<const int&, const int&> p : x)
+        s += p.first * p.second;
+    ASSERT_EQ(s, 6 + 20 + 42);
+    my_pair_vector<int, int>::const_iterator b = x.begin();
+    ASSERT_EQ(x.end() - b, 3);
+    ASSERT_EQ(b[2].second, 7);}
+
+TEST(Pair_Vector, test_4) {
+    my_pair_vector<int, int> x(3, my_pair<int, int>(1, 2));
+    for (my_pair<int&, int&> p : x)
+        ++p.second;
+    ASSERT_EQ(x.seconds(), vector<int>(3, 3));
+    ASSERT_TRUE((x == my_pair_vector<int, int>({{1, 3}, {1, 3}, {1, 3}})));
+    ASSERT_TRUE((x != my_pair_vector<int, int>({{1, 3}, {1, 3}})));}
+
+TEST(Pair_Vector, test_5) {
+    my_pair_vector<int, string> x = {{2, "a"}, {4, "b"}, {6, "c"}};
+    x[0] = my_pair<int, string>(5, "d");
+    x[1] = x[2];
+    ASSERT_EQ(x.firsts(),  vector<int>({5, 6, 6}));
+    ASSERT_EQ(x.seconds(), vector<string>({"d", "c", "c"}));
+    swap(x[0], x[2]);
+    ASSERT_EQ(x.firsts(),  vector<int>({6, 6, 5}));
+    ASSERT_EQ(x.seconds(), vector<string>({"c", "c", "d"}));}
+
+TEST(Pair_Vector, test_6) {
+    my_pair_vector<int, string> x = {{3, "c"}, {1, "a"}, {4, "d"}, {2, "b"}};
+    reverse(x.begin(), x.end());
+    ASSERT_EQ(x.firsts(),  vector<int>({2, 4, 1, 3}));
+    ASSERT_EQ(x.seconds(), vector<string>({"b", "d", "a", "c"}));
+    sort(x.begin(), x.end(), [] (const my_pair<int, string>& a, const my_pair<int, string>& b) {return a.first < b.first;});
+    ASSERT_EQ(x.firsts(),  vector<int>({1, 2, 3, 4}));
+    ASSERT_EQ(x.seconds(), vector<string>({"a", "b", "c", "d"}));}
+
+TEST(Pair_Vector, test_7) {
+    my_pair_vector<int, int> x;
+    for (int i = 0; i != 100; ++i)
+        x.emplace_back((i * 37) % 100, i);
+    sort(x.begin(), x.end(), [] (const my_pair<int, int>& a, const my_pair<int, int>& b) {return a.first < b.first;});
+    for (int i = 0; i != 100; ++i) {
+        ASSERT_EQ(x[i].first, i);
+        ASSERT_EQ((x[i].second * 37) % 100, i);}
+    const my_pair_vector<int, int>::iterator b = x.begin();
+    ASSERT_TRUE(b + 2 > b);
+    ASSERT_TRUE(b <= 2 + b);
+    ASSERT_TRUE(x.end() >= b);}
+
 /*
 % Pair
 Running main() from gtest_main.cc
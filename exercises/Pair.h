@@ -5,30 +5,128 @@
 #ifndef Pair_h
 #define Pair_h
 
+#include <type_traits> // decay, enable_if, is_convertible, is_empty
+#include <utility>     // forward, move
+
+/*
+a member of an empty type, like a stateless functor, takes no room: an empty member is [[no_unique_address]],
+which does what deriving from the empty type would, while first and second stay members, as in pair
+only empty members are marked, since a marked member of any other type may also lend its tail padding
+to the member after it, where a copy into first would overwrite second; the rest is laid out as in pair
+the copy and move operations are the defaulted ones, so my_pair is trivially copyable when T1 and T2 are
+*/
+
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(no_unique_address)
+#define MY_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+#endif
+#ifndef MY_NO_UNIQUE_ADDRESS
+#define MY_NO_UNIQUE_ADDRESS
+#endif
+
+// the members of a my_pair, with the attribute on the empty ones only
+template <typename T1, typename T2, bool = std::is_empty<T1>::value, bool = std::is_empty<T2>::value>
+struct my_pair_members {
+    T1 first;
+    T2 second;
+
+    my_pair_members () :
+            first  (),
+            second ()
+        {}
+
+    template <typename U1, typename U2>
+    my_pair_members (U1&& first, U2&& second) :
+            first  (std::forward<U1>(first)),
+            second (std::forward<U2>(second))
+        {}};
+
+template <typename T1, typename T2>
+struct my_pair_members<T1, T2, true, false> {
+    MY_NO_UNIQUE_ADDRESS T1 first;
+                         T2 second;
+
+    my_pair_members () :
+            first  (),
+            second ()
+        {}
+
+    template <typename U1, typename U2>
+    my_pair_members (U1&& first, U2&& second) :
+            first  (std::forward<U1>(first)),
+            second (std::forward<U2>(second))
+        {}};
+
+template <typename T1, typename T2>
+struct my_pair_members<T1, T2, false, true> {
+                         T1 first;
+    MY_NO_UNIQUE_ADDRESS T2 second;
+
+    my_pair_members () :
+            first  (),
+            second ()
+        {}
+
+    template <typename U1, typename U2>
+    my_pair_members (U1&& first, U2&& second) :
+            first  (std::forward<U1>(first)),
+            second (std::forward<U2>(second))
+        {}};
+
+template <typename T1, typename T2>
+struct my_pair_members<T1, T2, true, true> {
+    MY_NO_UNIQUE_ADDRESS T1 first;
+    MY_NO_UNIQUE_ADDRESS T2 second;
+
+    my_pair_members () :
+            first  (),
+            second ()
+        {}
+
+    template <typename U1, typename U2>
+    my_pair_members (U1&& first, U2&& second) :
+            first  (std::forward<U1>(first)),
+            second (std::forward<U2>(second))
+        {}};
+
 template <typename T1, typename T2>
-struct my_pair {
+struct my_pair : my_pair_members<T1, T2> {
     typedef T1 first_type;
     typedef T2 second_type;
 
-    T1 first;
-    T2 second;
+    my_pair () :
+            my_pair_members<T1, T2> ()
+        {}
 
-    my_pair (const T1& first = T1(), const T2& second = T2()) :
-            first  (first),
-            second (second)
+    my_pair (const T1& first, const T2& second = T2()) :
+            my_pair_members<T1, T2> (first, second)
+        {}
+
+    template <typename U1, typename U2,
+              typename = typename std::enable_if<std::is_convertible<U1, T1>::value && std::is_convertible<U2, T2>::value>::type>
+    my_pair (U1&& first, U2&& second) :
+            my_pair_members<T1, T2> (std::forward<U1>(first), std::forward<U2>(second))
         {}
 
     template <typename U1, typename U2>
     my_pair (const my_pair<U1, U2>& that) :
-            first  (that.first),
-            second (that.second)
+            my_pair_members<T1, T2> (that.first, that.second)
+        {}
+
+    template <typename U1, typename U2>
+    my_pair (my_pair<U1, U2>&& that) :
+            my_pair_members<T1, T2> (std::forward<U1>(that.first), std::forward<U2>(that.second))
         {}
 
+    my_pair             (const my_pair&) = default;
+    my_pair             (my_pair&&)      = default;
     my_pair& operator = (const my_pair&) = default;
+    my_pair& operator = (my_pair&&)      = default;
              ~my_pair   ()               = default;};
 
 template <typename T1, typename T2>
-my_pair<T1, T2> my_make_pair (const T1& first, const T2& second) {
-    return my_pair<T1, T2>(first, second);}
+my_pair<typename std::decay<T1>::type, typename std::decay<T2>::type> my_make_pair (T1&& first, T2&& second) {
+    return my_pair<typename std::decay<T1>::type, typename std::decay<T2>::type>(std::forward<T1>(first), std::forward<T2>(second));}
 
 #endif // Pair_h
@@ -0,0 +1,254 @@
+// ------------
+// PairVector.h
+// ------------
+
+// https://en.wikipedia.org/wiki/AoS_and_SoA
+
+#ifndef PairVector_h
+#define PairVector_h
+
+#include <cassert>          // assert
+#include <cstddef>          // ptrdiff_t, size_t
+#include <initializer_list> // initializer_list
+#include <iterator>         // random_access_iterator_tag
+#include <type_traits>      // is_same, remove_const
+#include <utility>          // forward, move, swap
+#include <vector>           // vector
+
+#include "Pair.h"
+
+/*
+a sequence of my_pair<T1, T2> kept as two vectors, one of the firsts and one of the seconds,
+so a scan of only the firsts reads only the firsts, and not every second in between
+
+an element is read as a my_pair of references into the two vectors, which converts to a my_pair of values;
+so v[i].first = x writes through, and my_pair<T1, T2> p = v[i] copies out
+assigning to v[i] assigns the elements it refers to, and swapping two of them swaps the elements,
+so sort, reverse and the other mutating algorithms work on the iterators
+firsts() and seconds() hand out the vectors themselves, for scans that want to see them as arrays
+*/
+
+// the reference of my_pair_vector_iterator: = and swap go through to the elements, not the references
+template <typename F, typename S>
+struct my_pair_vector_reference : my_pair<F&, S&> {
+    my_pair_vector_reference (F& f, S& s) :
+            my_pair<F&, S&> (f, s)
+        {}
+
+    my_pair_vector_reference (const my_pair_vector_reference&) = default;
+
+    // copies the elements, even from a temporary reference, since that refers to elements too
+    my_pair_vector_reference& operator = (const my_pair_vector_reference& rhs) {
+        this->first  = rhs.first;
+        this->second = rhs.second;
+        return *this;}
+
+    template <typename U1, typename U2>
+    my_pair_vector_reference& operator = (const my_pair<U1, U2>& rhs) {
+        this->first  = rhs.first;
+        this->second = rhs.second;
+        return *this;}
+
+    template <typename U1, typename U2>
+    my_pair_vector_reference& operator = (my_pair<U1, U2>&& rhs) {
+        this->first  = std::forward<U1>(rhs.first);
+        this->second = std::forward<U2>(rhs.second);
+        return *this;}
+
+    friend void swap (my_pair_vector_reference lhs, my_pair_vector_reference rhs) {
+        using std::swap;
+        swap(lhs.first,  rhs.first);
+        swap(lhs.second, rhs.second);}};
+
+template <typename F, typename S>
+class my_pair_vector_iterator {
+    template <typename, typename>
+    friend class my_pair_vector_iterator;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = my_pair<typename std::remove_const<F>::type, typename std::remove_const<S>::type>;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = my_pair_vector_reference<F, S>;
+        using pointer           = void;
+
+        friend bool operator == (const my_pair_vector_iterator& lhs, const my_pair_vector_iterator& rhs) {
+            return lhs._f == rhs._f;}
+
+        friend bool operator != (const my_pair_vector_iterator& lhs, const my_pair_vector_iterator& rhs) {
+            return !(lhs == rhs);}
+
+        friend bool operator < (const my_pair_vector_iterator& lhs, const my_pair_vector_iterator& rhs) {
+            return lhs._f < rhs._f;}
+
+        friend bool operator > (const my_pair_vector_iterator& lhs, const my_pair_vector_iterator& rhs) {
+            return rhs < lhs;}
+
+        friend bool operator <= (const my_pair_vector_iterator& lhs, const my_pair_vector_iterator& rhs) {
+            return !(rhs < lhs);}
+
+        friend bool operator >= (const my_pair_vector_iterator& lhs, const my_pair_vector_iterator& rhs) {
+            return !(lhs < rhs);}
+
+        friend difference_type operator - (const my_pair_vector_iterator& lhs, const my_pair_vector_iterator& rhs) {
+            return lhs._f - rhs._f;}
+
+        friend my_pair_vector_iterator operator + (my_pair_vector_iterator lhs, difference_type n) {
+            return lhs += n;}
+
+        friend my_pair_vector_iterator operator + (difference_type n, my_pair_vector_iterator rhs) {
+            return rhs += n;}
+
+        friend my_pair_vector_iterator operator - (my_pair_vector_iterator lhs, difference_type n) {
+            return lhs -= n;}
+
+    private:
+        F* _f;
+        S* _s;
+
+    public:
+        my_pair_vector_iterator (F* f = nullptr, S* s = nullptr) :
+                _f (f),
+                _s (s)
+            {}
+
+        // iterator to const_iterator
+        template <typename F2, typename S2>
+        my_pair_vector_iterator (const my_pair_vector_iterator<F2, S2>& rhs) :
+                _f (rhs._f),
+                _s (rhs._s)
+            {}
+
+        reference operator * () const {
+            return reference(*_f, *_s);}
+
+        reference operator [] (difference_type n) const {
+            return reference(_f[n], _s[n]);}
+
+        my_pair_vector_iterator& operator ++ () {
+            ++_f;
+            ++_s;
+            return *this;}
+
+        my_pair_vector_iterator operator ++ (int) {
+            my_pair_vector_iterator x = *this;
+            ++*this;
+            return x;}
+
+        my_pair_vector_iterator& operator -- () {
+            --_f;
+            --_s;
+            return *this;}
+
+        my_pair_vector_iterator operator -- (int) {
+            my_pair_vector_iterator x = *this;
+            --*this;
+            return x;}
+
+        my_pair_vector_iterator& operator += (difference_type n) {
+            _f += n;
+            _s += n;
+            return *this;}
+
+        my_pair_vector_iterator& operator -= (difference_type n) {
+            return *this += -n;}};
+
+template <typename T1, typename T2>
+class my_pair_vector {
+    static_assert(!std::is_same<T1, bool>::value && !std::is_same<T2, bool>::value, "my_pair_vector needs addressable elements, which vector<bool> doesn't have");
+
+    public:
+        using value_type      = my_pair<T1, T2>;
+        using size_type       = std::size_t;
+
+        using reference       = my_pair_vector_reference<T1, T2>;
+        using const_reference = my_pair<const T1&, const T2&>;
+
+        using iterator        = my_pair_vector_iterator<T1, T2>;
+        using const_iterator  = my_pair_vector_iterator<const T1, const T2>;
+
+    public:
+        friend bool operator == (const my_pair_vector& lhs, const my_pair_vector& rhs) {
+            return (lhs._f == rhs._f) && (lhs._s == rhs._s);}
+
+        friend bool operator != (const my_pair_vector& lhs, const my_pair_vector& rhs) {
+            return !(lhs == rhs);}
+
+    private:
+        std::vector<T1> _f;
+        std::vector<T2> _s;
+
+    public:
+        my_pair_vector () = default;
+
+        explicit my_pair_vector (size_type n, const value_type& v = value_type()) :
+                _f (n, v.first),
+                _s (n, v.second)
+            {}
+
+        my_pair_vector (std::initializer_list<value_type> rhs) {
+            reserve(rhs.size());
+            for (const value_type& v : rhs)
+                push_back(v);}
+
+        reference operator [] (size_type i) {
+            assert(i < size());
+            return reference(_f[i], _s[i]);}
+
+        const_reference operator [] (size_type i) const {
+            assert(i < size());
+            return const_reference(_f[i], _s[i]);}
+
+        iterator begin () {
+            return iterator(_f.data(), _s.data());}
+
+        const_iterator begin () const {
+            return const_iterator(_f.data(), _s.data());}
+
+        iterator end () {
+            return iterator(_f.data() + size(), _s.data() + size());}
+
+        const_iterator end () const {
+            return const_iterator(_f.data() + size(), _s.data() + size());}
+
+        bool empty () const {
+            return _f.empty();}
+
+        size_type size () const {
+            return _f.size();}
+
+        const std::vector<T1>& firsts () const {
+            return _f;}
+
+        const std::vector<T2>& seconds () const {
+            return _s;}
+
+        void reserve (size_type c) {
+            _f.reserve(c);
+            _s.reserve(c);}
+
+        template <typename U1, typename U2>
+        void emplace_back (U1&& first, U2&& second) {
+            _f.emplace_back(std::forward<U1>(first));
+            try {
+                _s.emplace_back(std::forward<U2>(second));}
+            catch (...) {
+                _f.pop_back();
+                throw;}}
+
+        void push_back (const value_type& v) {
+            emplace_back(v.first, v.second);}
+
+        void push_back (value_type&& v) {
+            emplace_back(std::move(v.first), std::move(v.second));}
+
+        void pop_back () {
+            assert(!empty());
+            _f.pop_back();
+            _s.pop_back();}
+
+        void clear () {
+            _f.clear();
+            _s.clear();}};
+
+#endif // PairVector_h
@@ -2,9 +2,19 @@
 // Range.c++
 // ---------
 
-#include <algorithm> // equal
+#include <algorithm> // equal, for_each
+#include <atomic>    // atomic
 #include <cassert>   // assert
+#include <climits>   // INT_MAX, INT_MIN, LLONG_MAX, LLONG_MIN
 #include <iostream>  // cout, endl
+#include <iterator>  // input_iterator_tag, iterator_traits
+#include <numeric>   // accumulate
+#include <thread>    // thread
+#include <vector>    // vector
+
+#if __cplusplus >= 201703L
+#include <execution> // par
+#endif
 
 #include "gtest/gtest.h"
 
@@ -62,6 +72,101 @@ TEST(RangeFixture, test_4) {
     Range<int> x = {2, 5};
     ASSERT_TRUE(equal(begin(x), end(x), begin({2, 3, 4})));}
 
+TEST(RangeFixture, test_5) {
+    using iterator = Range<int>::iterator;
+    ASSERT_TRUE((is_same<iterator_traits<iterator>::iterator_category, input_iterator_tag>::value));
+    ASSERT_TRUE((is_same<iterator_traits<iterator>::reference,         int>::value));
+    const Range<int> x = {0, 1000000000};
+    ASSERT_EQ(x.end() - x.begin(), 1000000000);
+    ASSERT_EQ(x.size(), 1000000000);
+    iterator b = x.begin();
+    b += 999999999;
+    ASSERT_EQ(*b, 999999999);
+    ASSERT_EQ(x[5], 5);
+    ASSERT_EQ(x.end() - b, 1);
+    ASSERT_TRUE(x.begin() < b);}
+
+TEST(RangeFixture, test_6) {
+    const Range<int> x = {2, 12, 3};
+    ASSERT_EQ(x.size(), 4);
+    ASSERT_TRUE(equal(x.begin(), x.end(), begin({2, 5, 8, 11})));
+    vector<int> y;
+    for (Range<int>::iterator e = x.end(); e != x.begin();)
+        y.push_back(*--e);
+    ASSERT_EQ(y, vector<int>({11, 8, 5, 2}));
+    ASSERT_EQ(*(x.end() - 1), 11);
+    ASSERT_TRUE((Range<int>(2, 2, 3).empty()));
+    ASSERT_TRUE((Range<int>(5, 2).empty()));
+    ASSERT_EQ((Range<int>(2, 13, 3).size()), 4);
+    ASSERT_EQ((Range<int>(2, 14, 3).size()), 4);}
+
+TEST(RangeFixture, test_7) {
+    const Range<int> x = {1, 22, 2};
+    const pair<Range<int>, Range<int>> p = x.split();
+    ASSERT_EQ(p.first.size(),  5);
+    ASSERT_EQ(p.second.size(), 6);
+    ASSERT_EQ(*p.first.begin(),  1);
+    ASSERT_EQ(*p.second.begin(), 11);
+    ASSERT_EQ(p.first.end(),     p.second.begin());
+    ASSERT_EQ(p.second.end(),    x.end());}
+
+TEST(RangeFixture, test_8) {
+    const Range<int>         x = {0, 10};
+    const vector<Range<int>> v = x.chunks(3);
+    ASSERT_EQ(v.size(), 3);
+    ASSERT_EQ(v[0].size(), 4);
+    ASSERT_EQ(v[1].size(), 3);
+    ASSERT_EQ(v[2].size(), 3);
+    ASSERT_EQ(v[0].begin(), x.begin());
+    ASSERT_EQ(v[0].end(),   v[1].begin());
+    ASSERT_EQ(v[1].end(),   v[2].begin());
+    ASSERT_EQ(v[2].end(),   x.end());
+    ASSERT_EQ(x.chunks(20).size(), 20);
+    ASSERT_TRUE(x.chunks(20)[19].empty());}
+
+TEST(RangeFixture, test_9) {
+    // a thread per chunk
+    const Range<long long> x = {0, 1000000};
+    vector<long long>      s(4);
+    vector<thread>         t;
+    const vector<Range<long long>> v = x.chunks(s.size());
+    for (size_t k = 0; k != v.size(); ++k)
+        t.push_back(thread([&, k] () {
+            s[k] = accumulate(v[k].begin(), v[k].end(), 0LL);}));
+    for (thread& h : t)
+        h.join();
+    ASSERT_EQ(accumulate(s.begin(), s.end(), 0LL), 499999500000LL);}
+
+#if __cplusplus >= 201703L
+TEST(RangeFixture, test_10) {
+    const Range<int> x = {0, 1000000};
+    atomic<long long> s(0);
+    for_each(execution::par, x.begin(), x.end(), [&] (int i) {s += i;});
+    ASSERT_EQ(s.load(), 499999500000LL);}
+#endif
+
+// ends at the limits of T
+TEST(RangeFixture, test_11) {
+    const Range<int> x(INT_MIN, INT_MAX, 2);
+    ASSERT_EQ(x.size(), 2147483648u);
+    ASSERT_EQ(x[0],              INT_MIN);
+    ASSERT_EQ(x[x.size() - 1],   INT_MAX - 1);
+    ASSERT_EQ(*(x.end() - 1),    INT_MAX - 1);
+    ASSERT_EQ(x.end() - x.begin(), 2147483648LL);
+    const pair<Range<int>, Range<int>> p = x.split();
+    ASSERT_EQ(*p.second.begin(), 0);
+    ASSERT_EQ(p.second.end(),    x.end());
+    ASSERT_EQ((Range<int>(INT_MIN, INT_MAX).size()), 4294967295u);
+    ASSERT_EQ((Range<int>(INT_MAX - 1, INT_MAX, 5).size()), 1u);}
+
+TEST(RangeFixture, test_12) {
+    const Range<long long> x(LLONG_MIN, LLONG_MAX, LLONG_MAX);
+    ASSERT_EQ(x.size(), 3u);
+    ASSERT_EQ(x[2], LLONG_MAX - 1);
+    const vector<Range<long long>> v = x.chunks(2);
+    ASSERT_EQ(*v[1].begin(), LLONG_MAX - 1);
+    ASSERT_EQ(v[1].end(),    x.end());}
+
 /*
 % Range
 Running main() from gtest_main.cc
@@ -5,9 +5,12 @@
 #ifndef Range_h
 #define Range_h
 
-#include <cstddef>  // ptrdiff_t
-#include <iterator> // input_iterator_tag, iterator
-#include <utility>  // !=
+#include <cassert>  // assert
+#include <cstddef>  // size_t
+#include <utility>  // !=, make_pair, pair
+#include <vector>   // vector
+
+#include "RangeIterator.h"
 
 /*
 namespace std {
@@ -37,54 +40,80 @@ inline bool operator != (const T& lhs, const T& rhs) {
 
 using std::rel_ops::operator!=;
 
-template <typename T>
-class Range {
-    private:
-        T _b;
-        T _e;
-
-    public:
-        class iterator : public std::iterator<std::input_iterator_tag, T> {
 /*
-            public:
-                using iterator_category = input_iterator_tag;
-                using value_type        = T;
-                using difference_type   = ptrdiff_t;
-                using pointer           = T*;
-                using reference         = T&;
+[b, e) by s, with iterators that jump in O(1), for an integral T
+split and chunks cut it into balanced sub-ranges with the same stride, for a thread pool;
+the sub-ranges cover the range exactly and in order
+the range is kept as its first element and its size, both computed without overflow, even for ends at the limits of T
 */
-            friend bool operator == (const iterator& lhs, const iterator& rhs) {
-                return (lhs._v == rhs._v);}
-
-            private:
-                T _v;
 
-            public:
-                iterator (const T& v) :
-                        _v (v)
-                    {}
-
-                const T& operator * () const {
-                    return _v;}
+template <typename T>
+class Range {
+    public:
+        using iterator  = Range_Iterator<T>;
+        using size_type = std::size_t;
 
-                iterator& operator ++ () {
-                    ++_v;
-                    return *this;}
+    private:
+        T         _b;
+        size_type _n;
+        T         _s;
 
-                iterator operator ++ (int) {
-                    iterator x = *this;
-                    ++*this;
-                    return x;}};
+        // the range of n elements from b by s
+        static Range sized (const T& b, size_type n, const T& s) {
+            Range x(b, b, s);
+            x._n = n;
+            return x;}
 
-        Range (const T& b, const T& e) :
+    public:
+        Range (const T& b, const T& e, const T& s = T(1)) :
                 _b (b),
-                _e (e)
-            {}
+                _n (0),
+                _s (s) {
+            assert(s > T(0));
+            using U = unsigned long long;
+            if (b < e)
+                _n = size_type(((U(e) - U(b) - 1) / U(s)) + 1);}
 
         iterator begin () const {
-            return iterator(_b);}
+            return iterator(_b, _s);}
 
         iterator end () const {
-            return iterator(_e);}};
+            return begin() + _n;}
+
+        size_type size () const {
+            return _n;}
+
+        bool empty () const {
+            return _n == 0;}
+
+        T stride () const {
+            return _s;}
+
+        T operator [] (size_type i) const {
+            return begin()[i];}
+
+        /**
+         * @return the first half, and the second, which gets the extra element of an odd size
+         */
+        std::pair<Range, Range> split () const {
+            const size_type m = size() / 2;
+            return std::make_pair(sized(_b, m, _s), sized((*this)[m], _n - m, _s));}
+
+        /**
+         * @param n the number of sub-ranges, at least 1
+         * @return n sub-ranges whose sizes differ by at most 1, the larger ones first
+         */
+        std::vector<Range> chunks (size_type n) const {
+            assert(n > 0);
+            const size_type q = size() / n;
+            const size_type r = size() % n;
+            std::vector<Range> v;
+            v.reserve(n);
+            size_type i = 0;
+            for (size_type k = 0; k != n; ++k) {
+                const size_type m = q + (k < r ? 1 : 0);
+                v.push_back(sized((*this)[i], m, _s));
+                i += m;}
+            return v;}};
 
 #endif // Range_h
@@ -39,6 +39,28 @@ TEST(RangeIteratorFixture, test_3) {
 TEST(RangeIteratorFixture, test_4) {
     ASSERT_TRUE(equal(Range_Iterator<int>(2), Range_Iterator<int>(5), begin({2, 3, 4})));}
 
+TEST(RangeIteratorFixture, test_5) {
+    Range_Iterator<int> b = 2;
+    Range_Iterator<int> e = b + 10;
+    ASSERT_EQ(*e, 12);
+    ASSERT_EQ(e - b, 10);
+    ASSERT_EQ(b[3], 5);
+    e -= 4;
+    ASSERT_EQ(*e, 8);
+    ASSERT_EQ(*--e, 7);
+    ASSERT_EQ(*e--, 7);
+    ASSERT_EQ(*(3 + b), 5);
+    ASSERT_TRUE(b < e);
+    ASSERT_TRUE(e >= b);
+    ASSERT_EQ(*(e - 1), 5);}
+
+TEST(RangeIteratorFixture, test_6) {
+    const Range_Iterator<int> b(2, 5);
+    const Range_Iterator<int> e(22, 5);
+    ASSERT_EQ(e - b, 4);
+    ASSERT_EQ(*(b + 2), 12);
+    ASSERT_TRUE(equal(b, e, begin({2, 7, 12, 17})));}
+
 /*
 % RangeIterator
 Running main() from gtest_main.cc
@@ -5,8 +5,9 @@
 #ifndef RangeIterator_h
 #define RangeIterator_h
 
+#include <cassert>  // assert
 #include <cstddef>  // ptrdiff_t
-#include <iterator> // input_iterator_tag, iterator
+#include <iterator> // input_iterator_tag, random_access_iterator_tag
 #include <utility>  // !=
 
 /*
@@ -37,37 +38,116 @@ inline bool operator != (const T& lhs, const T& rhs) {
 
 using std::rel_ops::operator!=;
 
-template <typename T>
-class Range_Iterator : public std::iterator<std::input_iterator_tag, T> {
 /*
+an iterator over T, from v by s at a time
+
+* returns T by value, so, to the standard library, it is an input iterator:
+a forward iterator's * must return a reference that outlives the iterator
+it still has +=, -, [] and <, all O(1), so code that knows it has a Range_Iterator
+jumps instead of stepping, and C++20 sees it as random access through iterator_concept
+std::distance, std::advance and the C++17 parallel algorithms go by iterator_category
+and step one at a time; Range::chunks() is the way to split a Range across threads
+
+an iterator is its origin, its stride, and how many strides it is past the origin;
+the value is computed in unsigned arithmetic, so an end past the largest T doesn't overflow
+*/
+
+template <typename T>
+class Range_Iterator {
     public:
-        using iterator_category = input_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
         using value_type        = T;
-        using difference_type   = ptrdiff_t;
-        using pointer           = T*;
-        using reference         = T&;
-*/
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = T;
+#if __cplusplus > 201703L
+        using iterator_concept  = std::random_access_iterator_tag;
+#endif
+
     friend bool operator == (const Range_Iterator& lhs, const Range_Iterator& rhs) {
-            return (lhs._v == rhs._v);}
+            return (lhs - rhs) == 0;}
+
+    friend bool operator != (const Range_Iterator& lhs, const Range_Iterator& rhs) {
+            return !(lhs == rhs);}
+
+    friend bool operator < (const Range_Iterator& lhs, const Range_Iterator& rhs) {
+            return (lhs - rhs) < 0;}
+
+    friend bool operator > (const Range_Iterator& lhs, const Range_Iterator& rhs) {
+            return (rhs < lhs);}
+
+    friend bool operator <= (const Range_Iterator& lhs, const Range_Iterator& rhs) {
+            return !(rhs < lhs);}
+
+    friend bool operator >= (const Range_Iterator& lhs, const Range_Iterator& rhs) {
+            return !(lhs < rhs);}
+
+    friend Range_Iterator operator + (Range_Iterator lhs, difference_type n) {
+            return lhs += n;}
+
+    friend Range_Iterator operator + (difference_type n, Range_Iterator rhs) {
+            return rhs += n;}
+
+    friend Range_Iterator operator - (Range_Iterator lhs, difference_type n) {
+            return lhs -= n;}
+
+    // iterators of one Range share an origin; others are compared by where their origins are
+    friend difference_type operator - (const Range_Iterator& lhs, const Range_Iterator& rhs) {
+            assert(lhs._s == rhs._s);
+            if (lhs._b == rhs._b)
+                return lhs._i - rhs._i;
+            using U = unsigned long long;
+            const difference_type d = (rhs._b < lhs._b) ?
+                   difference_type((U(lhs._b) - U(rhs._b)) / U(lhs._s)) :
+                  -difference_type((U(rhs._b) - U(lhs._b)) / U(lhs._s));
+            return d + (lhs._i - rhs._i);}
 
     private:
-        T _v;
+        T               _b;
+        T               _s;
+        difference_type _i;
 
     public:
-        Range_Iterator(const T& v) :
-                _v (v)
+        Range_Iterator () :
+                _b (),
+                _s (1),
+                _i (0)
             {}
 
-        const T& operator * () const {
-            return _v;}
+        Range_Iterator (const T& v, const T& s = T(1)) :
+                _b (v),
+                _s (s),
+                _i (0) {
+            assert(s > T(0));}
+
+        reference operator * () const {
+            using U = unsigned long long;
+            return T(U(_b) + (U(_i) * U(_s)));}
+
+        reference operator [] (difference_type n) const {
+            return *(*this + n);}
 
         Range_Iterator& operator ++ () {
-            ++_v;
-            return *this;}
+            return *this += 1;}
 
         Range_Iterator operator ++ (int) {
             Range_Iterator x = *this;
             ++*this;
-            return x;}};
+            return x;}
+
+        Range_Iterator& operator -- () {
+            return *this -= 1;}
+
+        Range_Iterator operator -- (int) {
+            Range_Iterator x = *this;
+            --*this;
+            return x;}
+
+        Range_Iterator& operator += (difference_type n) {
+            _i += n;
+            return *this;}
+
+        Range_Iterator& operator -= (difference_type n) {
+            return *this += -n;}};
 
 #endif // RangeIterator_h
@@ -0,0 +1,226 @@
+// ------
+// Simd.h
+// ------
+
+#ifndef Simd_h
+#define Simd_h
+
+#include <cstddef>     // size_t
+#include <cstdint>     // uint64_t, uintptr_t
+#include <cstring>     // memcmp, memcpy, memmove, memset
+#include <iterator>    // iterator_traits
+#include <type_traits> // integral_constant, is_enum, is_integral, is_pointer, is_same, is_trivially_copyable, remove_cv
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MY_SIMD_X86
+#include <immintrin.h> // _mm256_*, _mm_*
+#endif
+
+/*
+the fast paths of my_copy, my_fill and my_equal:
+traits that tell when iterators are raw pointers, or pointers in disguise, over trivially copyable types,
+and byte kernels for them, with 32-byte AVX2 loops where the CPU has AVX2, 16-byte SSE2 loops otherwise,
+and the C library elsewhere
+each kernel stores to aligned addresses in its main loop, and does the unaligned ends with one
+overlapping vector each, so nothing is done a byte at a time
+*/
+
+// -----------------
+// my_is_contiguous
+// -----------------
+
+// true if I's elements are adjacent in memory, so that &*b + n is &*(b + n)
+template <typename I>
+struct my_is_contiguous : std::false_type
+    {};
+
+template <typename T>
+struct my_is_contiguous<T*> : std::true_type
+    {};
+
+#ifdef __GLIBCXX__
+// the iterators of vector, string and array
+template <typename T, typename C>
+struct my_is_contiguous<__gnu_cxx::__normal_iterator<T*, C>> : std::true_type
+    {};
+#endif
+
+template <typename I>
+using my_value_type = typename std::remove_cv<typename std::iterator_traits<I>::value_type>::type;
+
+// true if [b, e) of I can be copied to x of O as bytes
+template <typename I, typename O>
+struct my_is_byte_copyable : std::integral_constant<bool,
+        my_is_contiguous<I>::value                                         &&
+        my_is_contiguous<O>::value                                         &&
+        std::is_same<my_value_type<I>, my_value_type<O>>::value            &&
+        std::is_trivially_copyable<my_value_type<I>>::value>
+    {};
+
+// true if == on T is == on its bytes; not for floating point, where 0.0 == -0.0 and NaN != NaN
+template <typename T>
+struct my_is_byte_comparable : std::integral_constant<bool,
+        std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value>
+    {};
+
+template <typename I1, typename I2>
+struct my_is_byte_equal : std::integral_constant<bool,
+        my_is_contiguous<I1>::value                                        &&
+        my_is_contiguous<I2>::value                                        &&
+        std::is_same<my_value_type<I1>, my_value_type<I2>>::value          &&
+        my_is_byte_comparable<my_value_type<I1>>::value>
+    {};
+
+// ----------
+// kernels
+// ----------
+
+#ifdef MY_SIMD_X86
+
+inline bool my_simd_has_avx2 () {
+    static const bool b = __builtin_cpu_supports("avx2");
+    return b;}
+
+// n >= 32, and [s, s + n) and [d, d + n) don't overlap
+__attribute__((target("avx2")))
+inline void my_simd_copy_avx2 (char* d, const char* s, std::size_t n) {
+    const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    const __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + n - 32));
+    const std::size_t a = 32 - (reinterpret_cast<std::uintptr_t>(d) & 31);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), h);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + n - 32), t);
+    char*       p = d + a;
+    const char* q = s + a;
+    char* const e = d + n - 32;
+    for (; (p + 128) <= e; p += 128, q += 128) {
+        const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q));
+        const __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q + 32));
+        const __m256i x2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q + 64));
+        const __m256i x3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q + 96));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p),      x0);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p + 32), x1);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p + 64), x2);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p + 96), x3);}
+    for (; p < e; p += 32, q += 32)
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q)));}
+
+// n >= 16, and [s, s + n) and [d, d + n) don't overlap
+inline void my_simd_copy_sse2 (char* d, const char* s, std::size_t n) {
+    const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + n - 16));
+    const std::size_t a = 16 - (reinterpret_cast<std::uintptr_t>(d) & 15);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), h);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + n - 16), t);
+    char*       p = d + a;
+    const char* q = s + a;
+    char* const e = d + n - 16;
+    for (; p < e; p += 16, q += 16)
+        _mm_store_si128(reinterpret_cast<__m128i*>(p), _mm_loadu_si128(reinterpret_cast<const __m128i*>(q)));}
+
+// n >= 32, and d a multiple of the period of the pattern in v
+__attribute__((target("avx2")))
+inline void my_simd_fill_avx2 (char* d, std::uint64_t v, std::size_t n) {
+    const __m256i x = _mm256_set1_epi64x(static_cast<long long>(v));
+    const std::size_t a = 32 - (reinterpret_cast<std::uintptr_t>(d) & 31);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), x);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + n - 32), x);
+    char*       p = d + a;
+    char* const e = d + n - 32;
+    for (; (p + 128) <= e; p += 128) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p),      x);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p + 32), x);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p + 64), x);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p + 96), x);}
+    for (; p < e; p += 32)
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p), x);}
+
+// n >= 16, and d a multiple of the period of the pattern in v
+inline void my_simd_fill_sse2 (char* d, std::uint64_t v, std::size_t n) {
+    const __m128i x = _mm_set1_epi64x(static_cast<long long>(v));
+    const std::size_t a = 16 - (reinterpret_cast<std::uintptr_t>(d) & 15);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), x);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + n - 16), x);
+    char*       p = d + a;
+    char* const e = d + n - 16;
+    for (; p < e; p += 16)
+        _mm_store_si128(reinterpret_cast<__m128i*>(p), x);}
+
+// n >= 32
+__attribute__((target("avx2")))
+inline bool my_simd_equal_avx2 (const char* b, const char* c, std::size_t n) {
+    const char* const e = b + n - 32;
+    for (; (b + 128) <= e; b += 128, c += 128) {
+        __m256i x = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)),      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c)));
+        x = _mm256_and_si256(x, _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 32)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + 32))));
+        x = _mm256_and_si256(x, _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 64)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + 64))));
+        x = _mm256_and_si256(x, _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 96)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + 96))));
+        if (_mm256_movemask_epi8(x) != -1)
+            return false;}
+    for (; b < e; b += 32, c += 32)
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c)))) != -1)
+            return false;
+    // the last 32 bytes, which may overlap the ones before
+    const std::ptrdiff_t k = e - b;
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(e)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + k)))) == -1;}
+
+#endif // MY_SIMD_X86
+
+/**
+ * copies n bytes from s to d, as memmove does
+ */
+inline void my_simd_copy (void* d, const void* s, std::size_t n) {
+    char* const       p = static_cast<char*>(d);
+    const char* const q = static_cast<const char*>(s);
+#ifdef MY_SIMD_X86
+    if (((p + n) <= q) || ((q + n) <= p)) {
+        if ((n >= 32) && my_simd_has_avx2()) {
+            my_simd_copy_avx2(p, q, n);
+            return;}
+        if (n >= 16) {
+            my_simd_copy_sse2(p, q, n);
+            return;}}
+#endif
+    std::memmove(p, q, n);}
+
+/**
+ * fills n Ts from d with v
+ * T must be trivially copyable
+ */
+template <typename T>
+inline void my_simd_fill (T* d, const T& v, std::size_t n) {
+    if (sizeof(T) == 1) {
+        unsigned char c;
+        std::memcpy(&c, &v, 1);
+        std::memset(d, c, n);
+        return;}
+#ifdef MY_SIMD_X86
+    // the kernels' aligned stores keep v's phase only if d is a multiple of sizeof(T),
+    // which a T of alignment less than its size, like a pair of ints, needn't be
+    if (((sizeof(T) == 2) || (sizeof(T) == 4) || (sizeof(T) == 8)) && ((reinterpret_cast<std::uintptr_t>(d) % sizeof(T)) == 0)) {
+        // v, repeated to fill 8 bytes
+        std::uint64_t w = 0;
+        for (std::size_t k = 0; k != (8 / sizeof(T)); ++k)
+            std::memcpy(reinterpret_cast<char*>(&w) + (k * sizeof(T)), &v, sizeof(T));
+        char* const       p = reinterpret_cast<char*>(d);
+        const std::size_t b = n * sizeof(T);
+        if ((b >= 32) && my_simd_has_avx2()) {
+            my_simd_fill_avx2(p, w, b);
+            return;}
+        if (b >= 16) {
+            my_simd_fill_sse2(p, w, b);
+            return;}}
+#endif
+    for (std::size_t k = 0; k != n; ++k)
+        d[k] = v;}
+
+/**
+ * @return true if the n bytes from b equal the n bytes from c, as memcmp would say
+ */
+inline bool my_simd_equal (const void* b, const void* c, std::size_t n) {
+#ifdef MY_SIMD_X86
+    if ((n >= 32) && my_simd_has_avx2())
+        return my_simd_equal_avx2(static_cast<const char*>(b), static_cast<const char*>(c), n);
+#endif
+    return std::memcmp(b, c, n) == 0;}
+
+#endif // Simd_h
@@ -0,0 +1,211 @@
+// -------------
+// SmallVector.h
+// -------------
+
+// http://llvm.org/docs/ProgrammersManual.html#llvm-adt-smallvector-h
+
+#ifndef SmallVector_h
+#define SmallVector_h
+
+#include <algorithm>   // equal, lexicographical_compare
+#include <cassert>     // assert
+#include <cstddef>     // size_t
+#include <memory>      // allocator, allocator_traits
+#include <type_traits> // is_nothrow_move_constructible
+#include <utility>     // forward, move, move_if_noexcept
+
+/*
+a vector whose first N elements live inside it, with no heap allocation;
+past N it moves everything to storage from its allocator and doubles from there
+just enough of vector for my_stack: back, push_back, emplace_back, pop_back, ==, <
+
+growth is all or nothing: if moving or copying an element to the new storage throws,
+the new storage is given back and the vector is as it was
+the move constructor is noexcept when the element's and the allocator's moves are,
+so a vector of my_small_vectors moves them, rather than copying them, when it grows
+*/
+
+template <typename T, std::size_t N, typename A = std::allocator<T>>
+class my_small_vector {
+    static_assert(N > 0, "my_small_vector needs room for at least one element inline");
+
+    public:
+        using value_type      = T;
+        using allocator_type  = A;
+        using size_type       = std::size_t;
+
+        using reference       = value_type&;
+        using const_reference = const value_type&;
+
+        using iterator        = value_type*;
+        using const_iterator  = const value_type*;
+
+    private:
+        using traits = std::allocator_traits<allocator_type>;
+
+    public:
+        friend bool operator == (const my_small_vector& lhs, const my_small_vector& rhs) {
+            return (lhs.size() == rhs.size()) && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        friend bool operator < (const my_small_vector& lhs, const my_small_vector& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    private:
+        allocator_type           _a;
+        value_type*              _b;
+        value_type*              _e;
+        value_type*              _l;
+        alignas(T) unsigned char _inline[N * sizeof(T)];
+
+        value_type* inline_begin () {
+            return reinterpret_cast<value_type*>(_inline);}
+
+        bool is_inline () const {
+            return _b == reinterpret_cast<const value_type*>(_inline);}
+
+        // moves the elements to new storage for c of them, or copies them if their move may throw
+        void grow (size_type c) {
+            assert(c > capacity());
+            value_type* const b = traits::allocate(_a, c);
+            value_type*       e = b;
+            try {
+                for (value_type* p = _b; p != _e; ++p, ++e)
+                    traits::construct(_a, e, std::move_if_noexcept(*p));}
+            catch (...) {
+                while (e != b)
+                    traits::destroy(_a, --e);
+                traits::deallocate(_a, b, c);
+                throw;}
+            destroy();
+            _b = b;
+            _e = e;
+            _l = b + c;}
+
+        // destroys the elements and gives back the heap storage, if any
+        void destroy () {
+            clear();
+            if (!is_inline())
+                traits::deallocate(_a, _b, capacity());}
+
+        void reset () {
+            _b = _e = inline_begin();
+            _l = _b + N;}
+
+        // takes the elements of rhs, by moving its heap storage if the allocators are equal, otherwise one by one
+        void steal (my_small_vector& rhs, bool equal) {
+            if (!rhs.is_inline() && equal) {
+                _b = rhs._b;
+                _e = rhs._e;
+                _l = rhs._l;
+                rhs.reset();
+                return;}
+            reserve(rhs.size());
+            for (value_type& v : rhs)
+                push_back(std::move(v));
+            rhs.clear();}
+
+    public:
+        explicit my_small_vector (const allocator_type& a = allocator_type()) :
+                _a (a) {
+            reset();}
+
+        my_small_vector (const my_small_vector& rhs) :
+                my_small_vector(rhs, traits::select_on_container_copy_construction(rhs._a))
+            {}
+
+        // delegates, so that the destructor cleans up if a copy throws
+        my_small_vector (const my_small_vector& rhs, const allocator_type& a) :
+                my_small_vector(a) {
+            reserve(rhs.size());
+            for (const value_type& v : rhs)
+                push_back(v);}
+
+        // an allocator moved from rhs's equals it, so heap storage is always taken whole, and an inline one fits
+        my_small_vector (my_small_vector&& rhs) noexcept(std::is_nothrow_move_constructible<value_type>::value && std::is_nothrow_move_constructible<allocator_type>::value) :
+                my_small_vector(std::move(rhs._a)) {
+            steal(rhs, true);}
+
+        my_small_vector (my_small_vector&& rhs, const allocator_type& a) :
+                my_small_vector(a) {
+            steal(rhs, _a == rhs._a);}
+
+        my_small_vector& operator = (const my_small_vector& rhs) {
+            if (this != &rhs) {
+                clear();
+                reserve(rhs.size());
+                for (const value_type& v : rhs)
+                    push_back(v);}
+            return *this;}
+
+        my_small_vector& operator = (my_small_vector&& rhs) {
+            if (this != &rhs) {
+                destroy();
+                reset();
+                steal(rhs, _a == rhs._a);}
+            return *this;}
+
+        ~my_small_vector () {
+            destroy();}
+
+        allocator_type get_allocator () const {
+            return _a;}
+
+        iterator begin () {
+            return _b;}
+
+        const_iterator begin () const {
+            return _b;}
+
+        iterator end () {
+            return _e;}
+
+        const_iterator end () const {
+            return _e;}
+
+        bool empty () const {
+            return _b == _e;}
+
+        size_type size () const {
+            return _e - _b;}
+
+        size_type capacity () const {
+            return _l - _b;}
+
+        reference back () {
+            assert(!empty());
+            return _e[-1];}
+
+        const_reference back () const {
+            assert(!empty());
+            return _e[-1];}
+
+        void reserve (size_type c) {
+            if (c > capacity())
+                grow(c);}
+
+        template <typename... Args>
+        void emplace_back (Args&&... args) {
+            if (_e == _l) {
+                // args may refer to an element, which grow moves
+                value_type v(std::forward<Args>(args)...);
+                grow(2 * capacity());
+                traits::construct(_a, _e, std::move_if_noexcept(v));}
+            else
+                traits::construct(_a, _e, std::forward<Args>(args)...);
+            ++_e;}
+
+        void push_back (const_reference v) {
+            emplace_back(v);}
+
+        void push_back (value_type&& v) {
+            emplace_back(std::move(v));}
+
+        void pop_back () {
+            assert(!empty());
+            traits::destroy(_a, --_e);}
+
+        void clear () {
+            while (!empty())
+                pop_back();}};
+
+#endif // SmallVector_h
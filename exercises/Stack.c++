@@ -4,13 +4,19 @@
 
 // http://www.cplusplus.com/reference/stack/stack/
 
-#include <cassert> // assert
-#include <list>    // list
-#include <stack>   // stack
-#include <vector>  // vector
+#include <cassert>     // assert
+#include <deque>       // deque
+#include <list>        // list
+#include <stack>       // stack
+#include <stdexcept>   // runtime_error
+#include <string>      // string
+#include <type_traits> // is_nothrow_move_constructible
+#include <utility>     // move
+#include <vector>      // vector
 
 #include "gtest/gtest.h"
 
+#include "Arena.h"
 #include "Stack.h"
 
 using namespace std;
@@ -28,7 +34,9 @@ typedef Types<
             stack<int, vector<int>>,
             my_stack<int>,
             my_stack<int, list<int>>,
-            my_stack<int, vector<int>>>
+            my_stack<int, vector<int>>,
+            my_small_stack<int, 2>,
+            my_small_stack<int, 8>>
         stack_types;
 
 TYPED_TEST_CASE(Stack_Fixture, stack_types);
@@ -125,6 +133,185 @@ TYPED_TEST(Stack_Fixture, test_5) {
     ASSERT_TRUE (x <= y);
     ASSERT_TRUE (x >= y);}
 
+TYPED_TEST(Stack_Fixture, test_6) {
+    using stack_type = typename TestFixture::stack_type;
+
+    stack_type x;
+    x.emplace(2);
+    x.emplace(3);
+    int v = 4;
+    x.push(move(v));
+    ASSERT_EQ(x.size(), 3);
+    ASSERT_EQ(x.top(),  4);
+
+    stack_type y = move(x);
+    ASSERT_EQ(y.size(), 3);
+    ASSERT_EQ(y.top(),  4);
+
+    stack_type z;
+    z.push(5);
+    z = move(y);
+    ASSERT_EQ(z.size(), 3);
+    z.pop();
+    ASSERT_EQ(z.top(),  3);}
+
+TYPED_TEST(Stack_Fixture, test_7) {
+    using stack_type = typename TestFixture::stack_type;
+
+    stack_type x;
+    x.push(2);
+    x.push(3);
+    x.push(4);
+
+    stack_type y;
+    y.push(5);
+
+    x.swap(y);
+    ASSERT_EQ(x.size(), 1);
+    ASSERT_EQ(x.top(),  5);
+    ASSERT_EQ(y.size(), 3);
+    ASSERT_EQ(y.top(),  4);}
+
+template <typename T>
+struct Stack_String_Fixture : Test {
+    using stack_type = T;};
+
+typedef Types<
+            stack<string>,
+            my_stack<string>,
+            my_stack<string, vector<string>>,
+            my_small_stack<string, 2>>
+        string_stack_types;
+
+TYPED_TEST_CASE(Stack_String_Fixture, string_stack_types);
+
+TYPED_TEST(Stack_String_Fixture, test_1) {
+    using stack_type = typename TestFixture::stack_type;
+
+    stack_type x;
+    string     s(100, 'a');
+    x.push(move(s));
+    ASSERT_TRUE(s.empty());
+    x.emplace(3, 'b');
+    x.emplace(100, 'c');
+    ASSERT_EQ(x.top(), string(100, 'c'));
+    x.pop();
+    ASSERT_EQ(x.top(), "bbb");
+    x.pop();
+    ASSERT_EQ(x.top(), string(100, 'a'));}
+
+TYPED_TEST(Stack_String_Fixture, test_2) {
+    using stack_type = typename TestFixture::stack_type;
+
+    stack_type x;
+    for (int i = 0; i != 10; ++i)
+        x.emplace(50, 'a' + i);
+    const stack_type y = x;
+    stack_type       z = move(x);
+    ASSERT_EQ(z, y);
+    ASSERT_EQ(z.top(), string(50, 'j'));}
+
+TEST(Stack_Small_Fixture, test_1) {
+    // a small stack moves to its allocator only past N
+    my_arena                                        a;
+    my_small_stack<int, 4, my_arena_allocator<int>> x((my_arena_allocator<int>(a)));
+    for (int i = 0; i != 4; ++i)
+        x.push(i);
+    ASSERT_EQ(a.blocks(), 0);
+    x.push(4);
+    ASSERT_EQ(a.blocks(), 1);
+    ASSERT_EQ(x.size(),   5);
+    ASSERT_EQ(x.top(),    4);}
+
+TEST(Stack_Small_Fixture, test_2) {
+    // pushing an element of the stack onto itself, as it grows
+    my_small_stack<string, 1> x;
+    x.emplace(20, 'a');
+    x.push(x.top());
+    x.emplace(x.top());
+    ASSERT_EQ(x.size(), 3);
+    ASSERT_EQ(x.top(),  string(20, 'a'));}
+
+struct thrower {
+    static int copies; // the number of copies that may succeed, -1 for any
+
+    int v;
+
+    thrower (int v) :
+            v (v)
+        {}
+
+    thrower (const thrower& rhs) :
+            v (rhs.v) {
+        if (copies == 0)
+            throw runtime_error("thrower");
+        if (copies > 0)
+            --copies;}
+
+    thrower& operator = (const thrower&) = default;
+
+    friend bool operator == (const thrower& lhs, const thrower& rhs) {
+        return lhs.v == rhs.v;}};
+
+int thrower::copies = -1;
+
+TEST(Stack_Small_Fixture, test_3) {
+    // a growth that throws partway leaves the vector as it was
+    my_small_vector<thrower, 2> x;
+    x.push_back(thrower(2));
+    x.push_back(thrower(3));
+    thrower::copies = 2;
+    ASSERT_THROW(x.push_back(thrower(4)), runtime_error);
+    thrower::copies = -1;
+    ASSERT_EQ(x.size(),     2);
+    ASSERT_EQ(x.capacity(), 2);
+    ASSERT_EQ(x.back().v,   3);
+    x.push_back(thrower(4));
+    ASSERT_EQ(x.size(),     3);
+    ASSERT_EQ(x.back().v,   4);}
+
+TEST(Stack_Small_Fixture, test_4) {
+    ASSERT_TRUE ((is_nothrow_move_constructible<my_small_vector<int,    4>>::value));
+    ASSERT_TRUE ((is_nothrow_move_constructible<my_small_vector<string, 4>>::value));
+    ASSERT_TRUE ((is_nothrow_move_constructible<my_small_stack <int,    4>>::value));
+    ASSERT_FALSE((is_nothrow_move_constructible<my_small_vector<thrower, 4>>::value));
+    vector<my_small_vector<string, 1>> v(1);
+    v[0].push_back(string(50, 'a'));
+    v[0].push_back(string(50, 'b'));
+    const string* const p = &v[0].back();
+    v.resize(v.capacity() + 1);
+    ASSERT_EQ(&v[0].back(), p);}
+
+TEST(Stack_Arena_Fixture, test_1) {
+    // many stacks, one arena
+    using allocator_type = my_arena_allocator<int>;
+    my_arena a;
+    for (int k = 0; k != 100; ++k) {
+        my_stack<int, deque <int, allocator_type>> x((allocator_type(a)));
+        my_stack<int, vector<int, allocator_type>> y((allocator_type(a)));
+        for (int i = 0; i != 10; ++i) {
+            x.push(i);
+            y.emplace(i);}
+        ASSERT_EQ(x.top(), 9);
+        ASSERT_EQ(y.top(), 9);}
+    ASSERT_LE(a.blocks(), 10);}
+
+TEST(Stack_Arena_Fixture, test_2) {
+    using allocator_type = my_arena_allocator<int>;
+    using stack_type     = my_stack<int, vector<int, allocator_type>>;
+    my_arena   a;
+    my_arena   b;
+    stack_type x((allocator_type(a)));
+    x.push(2);
+    x.push(3);
+    stack_type y(x, allocator_type(b));
+    ASSERT_EQ(y, x);
+    ASSERT_EQ(b.blocks(), 1);
+    stack_type z(move(y), allocator_type(a));
+    ASSERT_EQ(z, x);
+    stack_type w(vector<int, allocator_type>(3, 7, allocator_type(b)), allocator_type(a));
+    ASSERT_EQ(w.top(), 7);}
+
 /*
 % Stack
 Running main() from gtest_main.cc
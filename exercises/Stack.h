@@ -7,8 +7,14 @@
 #ifndef Stack_h
 #define Stack_h
 
-#include <cassert> // assert
-#include <utility> // !=, <=, >, >=
+#include <cassert>     // assert
+#include <cstddef>     // size_t
+#include <deque>       // deque
+#include <memory>      // uses_allocator
+#include <type_traits> // enable_if
+#include <utility>     // !=, <=, >, >=, forward, move
+
+#include "SmallVector.h"
 
 /*
 namespace std     {
@@ -57,15 +63,55 @@ class my_stack {
     private:
         container_type _c;
 
+        template <typename A>
+        using if_allocator = typename std::enable_if<std::uses_allocator<container_type, A>::value>::type;
+
     public:
-        explicit my_stack (const container_type& c = container_type()) :
+        // Not a default argument of the next, which would build a container only to copy it.
+        my_stack () :
+                _c ()
+            {}
+
+        explicit my_stack (const container_type& c) :
                 _c (c)
             {}
 
-        // Default copy, destructor, copy assignment.
+        explicit my_stack (container_type&& c) :
+                _c (std::move(c))
+            {}
+
+        // Allocator-extended, as in stack, so that the container can draw from a my_arena, say.
+        template <typename A, typename = if_allocator<A>>
+        explicit my_stack (const A& a) :
+                _c (a)
+            {}
+
+        template <typename A, typename = if_allocator<A>>
+        my_stack (const container_type& c, const A& a) :
+                _c (c, a)
+            {}
+
+        template <typename A, typename = if_allocator<A>>
+        my_stack (container_type&& c, const A& a) :
+                _c (std::move(c), a)
+            {}
+
+        template <typename A, typename = if_allocator<A>>
+        my_stack (const my_stack& rhs, const A& a) :
+                _c (rhs._c, a)
+            {}
+
+        template <typename A, typename = if_allocator<A>>
+        my_stack (my_stack&& rhs, const A& a) :
+                _c (std::move(rhs._c), a)
+            {}
+
+        // Default copy, move, destructor, copy assignment, move assignment.
                   my_stack   (const my_stack&)  = default;
+                  my_stack   (my_stack&&)       = default;
                   ~my_stack  ()                 = default;
         my_stack& operator = (const my_stack&)  = default;
+        my_stack& operator = (my_stack&&)       = default;
 
         bool empty () const {
             return _c.empty();}
@@ -76,6 +122,13 @@ class my_stack {
         void push (const_reference v) {
             _c.push_back(v);}
 
+        void push (value_type&& v) {
+            _c.push_back(std::move(v));}
+
+        template <typename... Args>
+        void emplace (Args&&... args) {
+            _c.emplace_back(std::forward<Args>(args)...);}
+
         size_type size () const {
             return _c.size();}
 
@@ -83,6 +136,14 @@ class my_stack {
             return _c.back();}
 
         const_reference top () const {
-            return _c.back();}};
+            return _c.back();}
+
+        void swap (my_stack& rhs) {
+            using std::swap;
+            swap(_c, rhs._c);}};
+
+// the first N elements inline, with no heap allocation
+template <typename T, std::size_t N, typename A = std::allocator<T>>
+using my_small_stack = my_stack<T, my_small_vector<T, N, A>>;
 
 #endif // Stack_h
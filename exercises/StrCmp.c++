@@ -4,9 +4,13 @@
 
 // http://www.cplusplus.com/reference/cstring/strcmp/
 
-#include <cstring>    // strcmp
+#include <cstring>    // memcpy, memset, strcmp, strncmp
 #include <functional> // function
 #include <iostream>   // cout, endl
+#include <string>     // string
+
+#include <sys/mman.h> // mmap, mprotect, munmap
+#include <unistd.h>   // sysconf
 
 #include "gtest/gtest.h"
 
@@ -56,6 +60,90 @@ TEST_P (Str_Cmp_Fixture, test_9) {
 TEST_P (Str_Cmp_Fixture, test_10) {
 	ASSERT_EQ(GetParam()("", "a"), 0 - 'a');}
 
+// long, with a shared prefix past several vectors, and the mismatch at every place around a vector's end
+TEST_P (Str_Cmp_Fixture, test_11) {
+	for (std::size_t k = 0; k != 100; ++k) {
+		std::string a(100, 'x');
+		std::string b(100, 'x');
+		ASSERT_EQ(GetParam()(a.c_str(), b.c_str()), 0);
+		b[k] = 'z';
+		ASSERT_EQ(GetParam()(a.c_str(), b.c_str()), 'x' - 'z');
+		ASSERT_EQ(GetParam()(b.c_str(), a.c_str()), 'z' - 'x');}}
+
+// long, with one a prefix of the other, ending at every place around a vector's end
+TEST_P (Str_Cmp_Fixture, test_12) {
+	const std::string a(100, 'x');
+	for (std::size_t k = 0; k != 100; ++k) {
+		const std::string b(k, 'x');
+		ASSERT_EQ(GetParam()(a.c_str(), b.c_str()), 'x' - 0);
+		ASSERT_EQ(GetParam()(b.c_str(), a.c_str()), 0 - 'x');}}
+
+// every pair of alignments
+TEST_P (Str_Cmp_Fixture, test_13) {
+	char a[128];
+	char b[128];
+	for (std::size_t i = 0; i != 32; ++i)
+		for (std::size_t j = 0; j != 32; ++j) {
+			std::memset(a, 'y', sizeof(a));
+			std::memset(b, 'y', sizeof(b));
+			a[i + 70] = 0;
+			b[j + 70] = 0;
+			ASSERT_EQ(GetParam()(a + i, b + j), 0);
+			b[j + 69] = 'w';
+			ASSERT_EQ(GetParam()(a + i, b + j), 'y' - 'w');}}
+
+// strings that end on the last byte before a page that can't be read
+TEST_P (Str_Cmp_Fixture, test_14) {
+	const std::size_t p = sysconf(_SC_PAGESIZE);
+	char* const m = static_cast<char*>(mmap(nullptr, 2 * p, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	ASSERT_NE(m, MAP_FAILED);
+	ASSERT_EQ(mprotect(m + p, p, PROT_NONE), 0);
+	char b[64];
+	for (std::size_t n = 0; n != 40; ++n) {
+		char* const a = m + p - n - 1;
+		std::memset(a, 'q', n);
+		a[n] = 0;
+		std::memcpy(b, a, n + 1);
+		ASSERT_EQ(GetParam()(a, b), 0);
+		ASSERT_EQ(GetParam()(b, a), 0);
+		ASSERT_EQ(GetParam()(a, m + p - 1), (n == 0) ? 0 : 'q');}
+	munmap(m, 2 * p);}
+
+using Str_N_Cmp_Signature = std::function<int (const char*, const char*, std::size_t)>;
+
+struct Str_N_Cmp_Fixture : TestWithParam<Str_N_Cmp_Signature> {};
+
+INSTANTIATE_TEST_CASE_P (
+	Str_N_Cmp_Instantiation,
+	Str_N_Cmp_Fixture,
+	Values(
+		   strncmp,
+		my_strncmp));
+
+TEST_P (Str_N_Cmp_Fixture, test_1) {
+	ASSERT_EQ(GetParam()("abc", "abd", 2), 0);}
+
+TEST_P (Str_N_Cmp_Fixture, test_2) {
+	ASSERT_EQ(GetParam()("abc", "abd", 3), 'c' - 'd');}
+
+TEST_P (Str_N_Cmp_Fixture, test_3) {
+	ASSERT_EQ(GetParam()("ab", "ab", 10), 0);}
+
+TEST_P (Str_N_Cmp_Fixture, test_4) {
+	ASSERT_EQ(GetParam()("ab", "abc", 10), 0 - 'c');}
+
+TEST_P (Str_N_Cmp_Fixture, test_5) {
+	ASSERT_EQ(GetParam()("", "a", 0), 0);}
+
+// long, with the mismatch at every place, and every n around it
+TEST_P (Str_N_Cmp_Fixture, test_6) {
+	for (std::size_t k = 0; k != 80; ++k) {
+		std::string a(100, 'x');
+		a[k] = 'a';
+		const std::string b(100, 'x');
+		for (std::size_t n = 0; n != 101; ++n)
+			ASSERT_EQ(GetParam()(a.c_str(), b.c_str(), n), (n > k) ? 'a' - 'x' : 0);}}
+
 /*
 % StrCmp
 Running main() from gtest_main.cc
@@ -5,10 +5,75 @@
 #ifndef StrCmp_h
 #define StrCmp_h
 
+#include <cstddef> // size_t
+#include <cstdint> // uintptr_t
+
+#include "Simd.h"
+
+/*
+16 or 32 bytes at a time, and a byte at a time where that isn't safe:
+a vector read may run past the NUL, which is fine as long as it stays on the page the NUL is on,
+since memory is mapped a page at a time; so a read that would cross a page is done by bytes until it wouldn't
+the result is the difference of the first pair of chars that differ, or of the NULs, as it always was
+*/
+
+#ifdef MY_SIMD_X86
+
+// the vector reads below run past the NUL on purpose, within the page, which AddressSanitizer would report
+#if defined(__GNUC__) || defined(__clang__)
+#define MY_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define MY_NO_SANITIZE_ADDRESS
+#endif
+
+// true if reading w bytes from p stays on p's page
+inline bool my_strcmp_page_safe (const char* p, std::size_t w) {
+    return (reinterpret_cast<std::uintptr_t>(p) & 4095) <= (4096 - w);}
+
+// a bit for each of the 32 bytes that ends the comparison: a mismatch or a NUL in a
+__attribute__((target("avx2"))) MY_NO_SANITIZE_ADDRESS
+inline unsigned my_strcmp_stops_avx2 (const char* a, const char* b) {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    const __m256i g = _mm256_andnot_si256(_mm256_cmpeq_epi8(x, _mm256_setzero_si256()), _mm256_cmpeq_epi8(x, y));
+    return ~static_cast<unsigned>(_mm256_movemask_epi8(g));}
+
+// the same for 16 bytes
+MY_NO_SANITIZE_ADDRESS
+inline unsigned my_strcmp_stops_sse2 (const char* a, const char* b) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    const __m128i g = _mm_andnot_si128(_mm_cmpeq_epi8(x, _mm_setzero_si128()), _mm_cmpeq_epi8(x, y));
+    return ~static_cast<unsigned>(_mm_movemask_epi8(g)) & 0xFFFF;}
+
+#endif // MY_SIMD_X86
+
+/**
+ * compares at most n chars of a and b, and none past a NUL
+ * @return the difference of the first chars that differ, 0 if none do
+ */
+int my_strncmp (const char* a, const char* b, std::size_t n) {
+    std::size_t i = 0;
+#ifdef MY_SIMD_X86
+    const bool        v = my_simd_has_avx2();
+    const std::size_t w = v ? 32 : 16;
+#endif
+    while (i != n) {
+#ifdef MY_SIMD_X86
+        if (((n - i) >= w) && my_strcmp_page_safe(a + i, w) && my_strcmp_page_safe(b + i, w)) {
+            const unsigned m = v ? my_strcmp_stops_avx2(a + i, b + i) : my_strcmp_stops_sse2(a + i, b + i);
+            if (m == 0) {
+                i += w;
+                continue;}
+            i += __builtin_ctz(m);
+            return a[i] - b[i];}
+#endif
+        if ((a[i] == 0) || (a[i] != b[i]))
+            return a[i] - b[i];
+        ++i;}
+    return 0;}
+
 int my_strcmp (const char* a, const char* b) {
-    while ((*a != 0) && (*a == *b)) {
-        ++a;
-        ++b;}
-    return *a - *b;}
+    return my_strncmp(a, b, static_cast<std::size_t>(-1));}
 
 #endif // StrCmp_h